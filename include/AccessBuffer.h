@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "CacheHash.h"
+#include "ShardArray.h"
+
+// BP-Wrapper式的访问缓冲：命中时只把节点下标写入无锁的环形缓冲，不去抢链表的锁；
+// 缓冲积累到一定数量后由写入者在独占锁内批量回放，把多次加锁合并成一次
+// 缓冲按线程分成若干条带，每个条带独占缓存行，线程只写自己所在的条带，写入只有一次fetch_add和一次store
+// 缓冲是有损的：条带写满后新的记录直接丢弃；回放与写入并发时个别记录也可能丢失，只影响LRU顺序的精确度
+// 记录保存节点下标和哈希的低32位，节点在记录之后被淘汰或复用时，回放方按哈希校验后跳过
+class AccessBuffer
+{
+public:
+    enum Status{
+        kRecorded,   // 已记录
+        kDrainable,  // 已记录，条带过半，可以尝试加锁回放
+        kFull,       // 条带已满，应当加锁回放
+    };
+
+    static const uint32_t kSlots = 32;             // 每个条带的记录个数
+    static const uint32_t kDrainThreshold = kSlots / 2;
+
+    explicit AccessBuffer(bool enabled);          // 条带数取不小于硬件线程数的2的幂，enabled为false时不分配缓冲
+
+    Status record(uint32_t node, size_t hash);
+
+    // 取出所有记录，依次调用fn(node, hash低32位)；调用者需持有独占锁，保证同一时刻只有一个回放者
+    template<typename Fn>
+    void drain(Fn fn);
+
+    size_t stripes() const { return stripes_.size(); }
+
+private:
+    struct Stripe{
+        Stripe() : tail(0) {
+            for(uint32_t i = 0; i < kSlots; i++) slots[i].store(0, std::memory_order_relaxed);
+        }
+        std::atomic<uint32_t> tail;                // 下一个写入位置，超过kSlots表示已满
+        std::atomic<uint64_t> slots[kSlots];       // 0表示空，否则为 节点下标<<32 | 哈希低32位
+    };
+
+    static size_t stripeCount(bool enabled);
+    static size_t threadSlot();                    // 当前线程的条带选择值，每个线程只计算一次
+
+private:
+    size_t stripeMask_;
+    ShardArray<Stripe> stripes_;
+};
+
+inline AccessBuffer::AccessBuffer(bool enabled)
+: stripeMask_(enabled ? stripeCount(enabled) - 1 : 0)
+, stripes_(stripeCount(enabled))
+{
+    for(size_t i = 0; i < stripes_.capacity(); i++){
+        stripes_.emplace_back();
+    }
+}
+
+inline size_t AccessBuffer::stripeCount(bool enabled)
+{
+    if(!enabled) return 0;
+    unsigned threads = std::thread::hardware_concurrency();
+    return roundUpPow2(threads > 0 ? threads : 1);
+}
+
+inline size_t AccessBuffer::threadSlot()
+{
+    static thread_local size_t slot = cacheMix64(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return slot;
+}
+
+inline AccessBuffer::Status AccessBuffer::record(uint32_t node, size_t hash)
+{
+    Stripe& stripe = stripes_[threadSlot() & stripeMask_];
+    uint32_t pos = stripe.tail.fetch_add(1, std::memory_order_relaxed);
+    if(pos >= kSlots) return kFull;
+    // 数据节点的下标不小于1，记录一定非0
+    stripe.slots[pos].store((static_cast<uint64_t>(node) << 32) | static_cast<uint32_t>(hash), std::memory_order_release);
+    if(pos + 1 == kSlots) return kFull;
+    return pos + 1 >= kDrainThreshold ? kDrainable : kRecorded;
+}
+
+template<typename Fn>
+void AccessBuffer::drain(Fn fn)
+{
+    for(size_t i = 0; i < stripes_.size(); i++){
+        Stripe& stripe = stripes_[i];
+        uint32_t count = stripe.tail.load(std::memory_order_acquire);
+        if(count == 0) continue;
+        if(count > kSlots) count = kSlots;
+        for(uint32_t pos = 0; pos < count; pos++){
+            // 写入者已领取位置但尚未写入时读到0，跳过该记录
+            uint64_t entry = stripe.slots[pos].exchange(0, std::memory_order_acquire);
+            if(entry != 0) fn(static_cast<uint32_t>(entry >> 32), static_cast<uint32_t>(entry));
+        }
+        stripe.tail.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
+
+// 标准ARC（Megiddo & Modha）：T1/T2为常驻链表，B1/B2为只保留key的幽灵链表，目标值p为T1的期望大小
+// 四条链表共用一个LruSlab节点池（容量2c）和一个key索引，节点在链表间迁移只修改下标
+// 命中幽灵链表时按|B2|/|B1|（或|B1|/|B2|）的比例调整p，而不是每次只移动一个容量
+template<typename Key, typename Value, typename Index = SwissIndex>
+class AdaptiveArcCache : public cachePolicy<Key, Value>
+{
+public:
+    using NodeSlab = LruSlab<Key, Value>;
+    using NodeMap = typename Index::template Map<Key, uint32_t>;  // key到节点下标的映射，包含幽灵节点
+
+    explicit AdaptiveArcCache(size_t capacity)
+    : capacity_(capacity)
+    , p_(0)
+    , nodeMap_(capacity * 2)
+    , slab_(capacity * 2, kListNum)
+    , listOf_(capacity * 2 + kListNum, kT1)
+    {}
+
+    ~AdaptiveArcCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+
+    size_t target() const { return p_; }    // 当前T1的目标大小
+
+private:
+    enum List : uint8_t { kT1 = 0, kT2 = 1, kB1 = 2, kB2 = 3 };
+    static const size_t kListNum = 4;
+
+    size_t listSize(List list) const { return sizes_[list]; }
+    void moveTo(List list, uint32_t node);        // 摘除节点并插入到list的尾部（MRU）
+    void replace(bool hitB2);                     // 按p从T1或T2淘汰一个节点到对应的幽灵链表
+    void dropLeastRecent(List list);              // 彻底删除list中最久未使用的节点
+    void addNewNode(const Key& key, const Value& value); // 不在任何链表中的新key
+
+private:
+    size_t capacity_;                 // 常驻节点容量c
+    size_t p_;                        // T1的目标大小，范围[0, c]
+    size_t sizes_[kListNum] = {0, 0, 0, 0};
+    NodeMap nodeMap_;
+    NodeSlab slab_;
+    std::vector<uint8_t> listOf_;     // 节点下标 -> 所在链表
+    std::mutex mutex_;
+};
+
+template<typename Key, typename Value, typename Index>
+void AdaptiveArcCache<Key, Value, Index>::put(Key key, Value value)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found == nullptr){
+        addNewNode(key, value);
+        return;
+    }
+    uint32_t node = *found;
+    switch(listOf_[node]){
+        case kT1:
+        case kT2:
+            // 常驻命中：更新value并移到T2的MRU
+            slab_[node].setValue(value);
+            moveTo(kT2, node);
+            return;
+        case kB1:{
+            // 最近被T1淘汰，说明T1偏小：p增加max(|B2|/|B1|, 1)
+            size_t delta = std::max<size_t>(listSize(kB2) / listSize(kB1), 1);
+            p_ = std::min(capacity_, p_ + delta);
+            replace(false);
+            break;
+        }
+        case kB2:{
+            // 最近被T2淘汰，说明T2偏小：p减小max(|B1|/|B2|, 1)
+            size_t delta = std::max<size_t>(listSize(kB1) / listSize(kB2), 1);
+            p_ = p_ > delta ? p_ - delta : 0;
+            replace(true);
+            break;
+        }
+    }
+    // 幽灵节点复活，直接进入T2
+    slab_[node].setValue(value);
+    moveTo(kT2, node);
+}
+
+template<typename Key, typename Value, typename Index>
+bool AdaptiveArcCache<Key, Value, Index>::get(Key key, Value& value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found == nullptr) return false;
+    uint32_t node = *found;
+    // 幽灵节点没有value，按未命中处理，等put带着value回来时再调整p
+    if(listOf_[node] != kT1 && listOf_[node] != kT2) return false;
+    moveTo(kT2, node);
+    value = slab_[node].getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index>
+Value AdaptiveArcCache<Key, Value, Index>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index>
+void AdaptiveArcCache<Key, Value, Index>::moveTo(List list, uint32_t node)
+{
+    --sizes_[listOf_[node]];
+    slab_.moveToBack(list, node);
+    listOf_[node] = list;
+    ++sizes_[list];
+}
+
+template<typename Key, typename Value, typename Index>
+void AdaptiveArcCache<Key, Value, Index>::replace(bool hitB2)
+{
+    size_t t1 = listSize(kT1);
+    if(t1 > 0 && (t1 > p_ || (hitB2 && t1 == p_))){
+        uint32_t node = slab_.front(kT1);
+        slab_[node].setValue(Value());
+        moveTo(kB1, node);
+    }
+    else if(listSize(kT2) > 0){
+        uint32_t node = slab_.front(kT2);
+        slab_[node].setValue(Value());
+        moveTo(kB2, node);
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void AdaptiveArcCache<Key, Value, Index>::dropLeastRecent(List list)
+{
+    uint32_t node = slab_.front(list);
+    if(node == NodeSlab::npos) return;
+    slab_.unlink(node);
+    --sizes_[list];
+    nodeMap_.erase(slab_[node].getKey());
+    slab_.release(node);
+}
+
+template<typename Key, typename Value, typename Index>
+void AdaptiveArcCache<Key, Value, Index>::addNewNode(const Key& key, const Value& value)
+{
+    size_t l1 = listSize(kT1) + listSize(kB1);
+    size_t total = l1 + listSize(kT2) + listSize(kB2);
+    if(l1 == capacity_){
+        // L1已满：B1有空间可让时淘汰B1最旧的幽灵并腾出一个常驻位置，否则T1独占c个位置，直接丢弃T1最旧的节点
+        if(listSize(kT1) < capacity_){
+            dropLeastRecent(kB1);
+            replace(false);
+        }
+        else{
+            dropLeastRecent(kT1);
+        }
+    }
+    else if(total >= capacity_){
+        if(total == capacity_ * 2){
+            dropLeastRecent(kB2);
+        }
+        replace(false);
+    }
+    uint32_t node = slab_.allocate(key, value);
+    slab_.pushBack(kT1, node);
+    listOf_[node] = kT1;
+    ++sizes_[kT1];
+    nodeMap_.insert(key, node);
+}
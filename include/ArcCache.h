@@ -2,20 +2,24 @@
 
 #include <memory>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "CachePolicy.h"
+#include "LockPolicy.h"
 #include "ArcLru.h"
 #include "ArcLfu.h"
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>, typename Lock = std::mutex>
 class ArcCache : public cachePolicy<Key, Value>
 {
 public:
-    explicit ArcCache(size_t capacity, size_t transformThreshold)
+    // promotionRatio为ArcLru的提升节流比例，见ArcLru
+    explicit ArcCache(size_t capacity, size_t transformThreshold, double promotionRatio = 0)
     : capacity_(capacity)
     , transformThreshold_(transformThreshold)
-    , lru(new ArcLru<Key, Value>(capacity, transformThreshold))
-    , lfu(new ArcLfu<Key, Value>(capacity, transformThreshold))
+    , lru(new ArcLru<Key, Value, Index, Hash>(capacity, transformThreshold, promotionRatio))
+    , lfu(new ArcLfu<Key, Value, Index, Hash>(capacity, transformThreshold))
     {}
 
     ~ArcCache() override = default;
@@ -24,106 +28,235 @@ public:
     bool get(Key key, Value& value);
     Value get(Key key);
 
+    // hash为cacheHashOf(Hash(), key)，由分片包装类算好传入；同一个哈希值同时用作索引哈希和幽灵指纹
+    void put(Key key, Value value, size_t hash);
+    bool get(Key key, Value& value, size_t hash);
+
+    // 调整容量：LRU、LFU两部分的容量同时加减相同的量，保留幽灵命中学到的两者之差，两部分之和仍为容量的2倍；
+    // 超出的条目分摊到之后的插入中淘汰
+    void setCapacity(size_t capacity);
+    size_t size();                           // 主缓存中的条目数，取LRU、LFU两部分的较大者（提升到LFU的条目两边都有）
+
+    // 供分片包装类在分片之间迁移条目，见SliceTable；迁移的条目进入LRU部分，原有的访问计数不保留
+    bool take(const Key& key, size_t hash, Value& value);          // 从两部分移出条目并取回value，不存在时返回false
+    bool peek(const Key& key, size_t hash, Value& value);          // 读取value，不改变访问顺序、不触发提升
+    bool eraseIfEqual(const Key& key, size_t hash, const Value& value); // value未改变时从两部分移出条目
+    bool putIfAbsent(Key key, Value value, size_t hash);           // 两部分都不存在时插入，已存在时不覆盖
+    // 从cursor（初始为0）起最多扫描limit个节点位置，收集哈希满足pred(hash)的key及其哈希；整个分片扫描完时返回true
+    template<typename Pred>
+    bool collectKeys(Pred pred, size_t& cursor, size_t limit, std::vector<std::pair<Key, size_t>>& keys);
+
 private:
-    bool checkGhostCaches(Key key);
+    bool checkGhostCaches(size_t hash);
 
 private:
-    // 细粒度锁：分别保护 LRU 与 LFU
-    std::mutex lruMutex_;
-    std::mutex lfuMutex_;
+    // 细粒度锁：分别保护 LRU 与 LFU，锁策略见LockPolicy.h
+    Lock lruMutex_;
+    Lock lfuMutex_;
 
     size_t capacity_;                        // 缓存容量
     size_t transformThreshold_;              // 定义多少次访问后从Lru迁移到Lfu阈值
-    std::unique_ptr<ArcLru<Key, Value>> lru; // lru缓存
-    std::unique_ptr<ArcLfu<Key, Value>> lfu; // lfu缓存
+    std::unique_ptr<ArcLru<Key, Value, Index, Hash>> lru; // lru缓存
+    std::unique_ptr<ArcLfu<Key, Value, Index, Hash>> lfu; // lfu缓存
 };
 
-template<typename Key, typename Value>
-void ArcCache<Key, Value>::put(Key key, Value value)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void ArcCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value)
+{
+    put(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void ArcCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value, size_t hash)
 {
     // 函数内部自己加锁
-    checkGhostCaches(key);
+    checkGhostCaches(hash);
 
     bool inLfu = false;
 
     // 先查询LFU是否已经包含该key（只锁 LFU）
     {
-        std::lock_guard<std::mutex> lock(lfuMutex_);
-        inLfu = lfu->contain(key);
+        std::lock_guard<Lock> lock(lfuMutex_);
+        inLfu = lfu->contain(key, hash);
     }
 
     // 更新LRU（只锁LRU）
     {
-        std::lock_guard<std::mutex> lock(lruMutex_);
-        lru->put(key, value);
+        std::lock_guard<Lock> lock(lruMutex_);
+        lru->put(key, value, hash);
     }
 
     // 如果LFU中也存在该key，则同步更新LFU（只锁LFU）
     if (inLfu) {
-        std::lock_guard<std::mutex> lock(lfuMutex_);
-        lfu->put(key, value);
+        std::lock_guard<Lock> lock(lfuMutex_);
+        lfu->put(key, value, hash);
     }
 }
 
-template<typename Key, typename Value>
-bool ArcCache<Key, Value>::get(Key key, Value& value)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value)
+{
+    return get(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value, size_t hash)
 {
-    checkGhostCaches(key);
+    checkGhostCaches(hash);
 
     bool shouldTransform = false;
     bool inLru = false;
 
     // 先查LRU（只锁LRU）
     {
-        std::lock_guard<std::mutex> lock(lruMutex_);
-        inLru = lru->get(key, value, shouldTransform);
+        std::lock_guard<Lock> lock(lruMutex_);
+        inLru = lru->get(key, value, shouldTransform, hash);
     }
 
     if (inLru) {
         // 命中LRU
         if (shouldTransform) {
             // ARC内部的“提升”逻辑：需要放入LFU
-            // 注意这里不再持有LRU的锁，只锁LFU，避免双锁死锁
-            std::lock_guard<std::mutex> lock(lfuMutex_);
-            lfu->put(key, value);
+            // 释放LRU锁期间条目可能已被分片迁移移出或被put更新，按LRU、LFU的顺序重新加锁，确认仍在LRU中并取当前的value，
+            // 否则会在已迁出的分片里重新放入一份旧值
+            std::lock_guard<Lock> lockLru(lruMutex_);
+            std::lock_guard<Lock> lockLfu(lfuMutex_);
+            Value current;
+            if (lru->peek(key, hash, current)) lfu->put(key, current, hash);
         }
         return true;
     }
 
     // LRU 未命中，再查LFU（只锁LFU）
     {
-        std::lock_guard<std::mutex> lock(lfuMutex_);
-        return lfu->get(key, value);
+        std::lock_guard<Lock> lock(lfuMutex_);
+        return lfu->get(key, value, hash);
     }
 }
 
-template<typename Key, typename Value>
-Value ArcCache<Key, Value>::get(Key key)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+Value ArcCache<Key, Value, Index, Hash, Lock>::get(Key key)
 {
     Value value{};
     get(key, value);
     return value;
 }
 
-template<typename Key, typename Value>
-bool ArcCache<Key, Value>::checkGhostCaches(Key key)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void ArcCache<Key, Value, Index, Hash, Lock>::setCapacity(size_t capacity)
+{
+    // 锁顺序与checkGhostCaches一致：先LRU再LFU
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
+    // 幽灵命中只在两部分之间转移容量，两部分之和始终为capacity_ * 2
+    size_t lruCapacity = lru->capacity() + capacity;
+    lruCapacity = lruCapacity > capacity_ ? lruCapacity - capacity_ : 0;
+    if(lruCapacity > capacity * 2) lruCapacity = capacity * 2;
+    // 幽灵缓存与构造时一样按总容量设置，不随两部分之间学到的容量差变化，容量被压小的一侧仍能靠幽灵命中要回容量
+    lru->setCapacity(lruCapacity, capacity);
+    lfu->setCapacity(capacity * 2 - lruCapacity, capacity);
+    capacity_ = capacity;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+size_t ArcCache<Key, Value, Index, Hash, Lock>::size()
+{
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
+    return lru->size() > lfu->size() ? lru->size() : lfu->size();
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcCache<Key, Value, Index, Hash, Lock>::take(const Key& key, size_t hash, Value& value)
+{
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
+    // 条目可能同时在两部分中，两边都要移出；LRU部分的value与put同步更新，优先取它
+    Value lfuValue;
+    bool inLfu = lfu->take(key, hash, lfuValue);
+    if(lru->take(key, hash, value)) return true;
+    if(inLfu) value = lfuValue;
+    return inLfu;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcCache<Key, Value, Index, Hash, Lock>::peek(const Key& key, size_t hash, Value& value)
+{
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
+    return lru->peek(key, hash, value) || lfu->peek(key, hash, value);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcCache<Key, Value, Index, Hash, Lock>::eraseIfEqual(const Key& key, size_t hash, const Value& value)
+{
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
+    Value current;
+    if(!lru->peek(key, hash, current) && !lfu->peek(key, hash, current)) return false;
+    if(!(current == value)) return false;
+    lru->take(key, hash, current);
+    lfu->take(key, hash, current);
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcCache<Key, Value, Index, Hash, Lock>::putIfAbsent(Key key, Value value, size_t hash)
+{
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
+    if(lru->contain(key, hash) || lfu->contain(key, hash)) return false;
+    return lru->put(key, value, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+template<typename Pred>
+bool ArcCache<Key, Value, Index, Hash, Lock>::collectKeys(Pred pred, size_t& cursor, size_t limit, std::vector<std::pair<Key, size_t>>& keys)
+{
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
+    // cursor最低位表示当前扫描的部分（0为LRU部分，1为LFU部分），其余位为该部分节点池中的位置
+    size_t pos = cursor >> 1;
+    if((cursor & 1) == 0){
+        bool done = lru->forEachKey(pos, limit, [&](const Key& key, size_t hash){
+            if(pred(hash)) keys.push_back(std::make_pair(key, hash));
+        });
+        cursor = done ? 1 : pos << 1;
+        return false;
+    }
+    // 同时在两部分中的key只收集一次
+    bool done = lfu->forEachKey(pos, limit, [&](const Key& key, size_t hash){
+        if(pred(hash) && !lru->contain(key, hash)) keys.push_back(std::make_pair(key, hash));
+    });
+    cursor = (pos << 1) | 1;
+    return done;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcCache<Key, Value, Index, Hash, Lock>::checkGhostCaches(size_t hash)
 {
     bool inGhost = false;
 
+    // 先用计数布隆过滤器无锁预判，绝大多数操作不会命中幽灵缓存，直接返回而不去抢两把锁
+    uint64_t fp = ArcGhostList::fingerprintOf(hash);
+    if (!lru->ghostMayContain(fp) && !lfu->ghostMayContain(fp)) {
+        return false;
+    }
+
     // ghost 命中会同时操作 LRU ghost / LFU ghost 和两边容量
     // 这里需要“原子性”，所以一次性锁住LRU和LFU，锁顺序固定：先LRU再LFU
-    std::lock_guard<std::mutex> lockLru(lruMutex_);
-    std::lock_guard<std::mutex> lockLfu(lfuMutex_);
+    std::lock_guard<Lock> lockLru(lruMutex_);
+    std::lock_guard<Lock> lockLfu(lfuMutex_);
 
     // 命中 LRU 的幽灵缓存：减小 LFU 容量，增加 LRU 容量
-    if (lru->eraseGhost(key)) {
+    if (lru->eraseGhost(fp)) {
         if (lfu->decreaseCapacity()) {
             lru->increaseCapacity();
         }
         inGhost = true;
     }
     // 命中 LFU 的幽灵缓存：减小 LRU 容量，增加 LFU 容量
-    else if (lfu->eraseGhost(key)) {
+    else if (lfu->eraseGhost(fp)) {
         if (lru->decreaseCapacity()) {
             lfu->increaseCapacity();
         }
@@ -1,38 +1,109 @@
 #pragma once
 
-#include <memory>
+#include <cstdint>
+#include <deque>
+#include <vector>
 
 // 前向声明
-template<typename Key, typename Value> class ArcLru;
-template<typename Key, typename Value> class ArcLfu;
+template<typename Key, typename Value, typename Index, typename Hash> class ArcLru;
+template<typename Key, typename Value> class ArcNodePool;
+template<typename Key, typename Value, typename Index, typename Hash> class ArcLfu;
+template<typename Key, typename Value> struct ArcFreqBucket;
 
 
 template<typename Key, typename Value>
 class ArcNode
 {
 public:
-    ArcNode() : accessCount_(1), next_(nullptr) {}
-    ArcNode(Key key, Value value)
+    ArcNode() : hash_(0), accessCount_(1), stamp_(0), inUse_(false), prev_(nullptr), next_(nullptr), bucket_(nullptr) {}
+    ArcNode(Key key, Value value, size_t hash = 0)
     : key_(key)
     , value_(value)
+    , hash_(hash)
     , accessCount_(1)
+    , stamp_(0)
+    , inUse_(false)
+    , prev_(nullptr)
     , next_(nullptr)
+    , bucket_(nullptr)
     {}
 
     Key getKey() const { return key_; }
     Value getValue() const { return value_; }
+    size_t getHash() const { return hash_; }
     size_t getAccessCount() const { return accessCount_; }
     
     void setValue(const Value& value) { value_ = value; }
     void increamentAccessCount() { ++accessCount_; }
 
-    friend class ArcLru<Key, Value>;
-    friend class ArcLfu<Key, Value>;
+    template<typename K, typename V, typename I, typename H> friend class ArcLru;
+    template<typename K, typename V, typename I, typename H> friend class ArcLfu;
+    template<typename K, typename V> friend class ArcNodePool;
 
 private:
     Key key_;
     Value value_;
+    size_t hash_;          // key的CacheHash，淘汰时直接按哈希删除索引、生成幽灵指纹
     size_t accessCount_;
-    std::weak_ptr<ArcNode<Key, Value>> prev_;
-    std::shared_ptr<ArcNode<Key, Value>> next_;
-};
\ No newline at end of file
+    uint32_t stamp_;       // 最近一次移到ArcLru链表头部时的代数，用于提升节流
+    bool inUse_;           // 是否已由ArcNodePool分配出去，空闲节点和哨兵为false
+    // 侵入式链表指针，节点由ArcLru/ArcLfu各自的ArcNodePool持有
+    ArcNode<Key, Value>* prev_;
+    ArcNode<Key, Value>* next_;
+    ArcFreqBucket<Key, Value>* bucket_;  // 节点在ArcLfu中所属的频次桶
+};
+
+// ARC节点池：节点存放在std::deque中，扩充时已有节点的地址不变，索引和侵入式链表直接保存裸指针
+// 释放的节点进入空闲列表复用，缓存装满之后插入、淘汰都不再分配内存，命中和移动节点也没有引用计数的原子操作
+template<typename Key, typename Value>
+class ArcNodePool
+{
+public:
+    using NodeType = ArcNode<Key, Value>;
+
+    NodeType* allocate(const Key& key, const Value& value, size_t hash);  // 优先复用空闲节点
+    void release(NodeType* node);   // 归还节点，同时释放value持有的资源
+
+    // 按节点在池中的位置从cursor（初始为0）起最多扫描limit个位置，对已分配的节点调用fn(node)；全部扫描完时返回true
+    // 节点的位置不变，分批扫描之间的分配、释放不会让尚未扫描的节点错位
+    template<typename Fn>
+    bool forEachFrom(size_t& cursor, size_t limit, Fn fn);
+
+private:
+    std::deque<NodeType> nodes_;
+    std::vector<NodeType*> freeNodes_;
+};
+
+template<typename Key, typename Value>
+typename ArcNodePool<Key, Value>::NodeType* ArcNodePool<Key, Value>::allocate(const Key& key, const Value& value, size_t hash)
+{
+    if(freeNodes_.empty()){
+        nodes_.emplace_back(key, value, hash);
+        nodes_.back().inUse_ = true;
+        return &nodes_.back();
+    }
+    NodeType* node = freeNodes_.back();
+    freeNodes_.pop_back();
+    *node = NodeType(key, value, hash);
+    node->inUse_ = true;
+    return node;
+}
+
+template<typename Key, typename Value>
+void ArcNodePool<Key, Value>::release(NodeType* node)
+{
+    node->setValue(Value());
+    node->inUse_ = false;
+    freeNodes_.push_back(node);
+}
+
+template<typename Key, typename Value>
+template<typename Fn>
+bool ArcNodePool<Key, Value>::forEachFrom(size_t& cursor, size_t limit, Fn fn)
+{
+    size_t end = cursor + limit < nodes_.size() ? cursor + limit : nodes_.size();
+    for(; cursor < end; cursor++){
+        if(nodes_[cursor].inUse_) fn(nodes_[cursor]);
+    }
+    return cursor == nodes_.size();
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "CacheHash.h"
+#include "FlatHashMap.h"
+
+// ARC的幽灵缓存：只记录被淘汰key的64位指纹，不保存节点和value
+// 指纹按淘汰顺序写入定长环形数组，写满后覆盖最旧的位置；索引记录指纹所在位置，命中检测为O(1)
+// 环形数组和索引在构造时一次性分配，之后的添加、删除都不会分配内存
+// 另外维护一个计数布隆过滤器，与幽灵缓存同步增减，供其他线程不加锁地预判是否可能命中
+// 所属缓存调整容量时用resize重建环形数组和索引；过滤器可能正被其他线程无锁读取，不重新分配，只减去被丢弃的指纹
+class ArcGhostList
+{
+public:
+    explicit ArcGhostList(size_t capacity)
+    : ring_(capacity, 0)
+    , pos_(0)
+    , index_(capacity)
+    , filterMask_(filterSize(capacity) - 1)
+    , filter_(filterSize(capacity))
+    {
+        for(auto& counter : filter_){
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename Key>
+    static uint64_t fingerprint(const Key& key);   // 计算key的指纹，0保留表示空位
+    static uint64_t fingerprintOf(size_t hash) { return hash == 0 ? 1 : hash; } // 由已算好的CacheHash得到指纹
+
+    void add(uint64_t fp);                          // 记录被淘汰的key，已存在时刷新为最新
+    bool erase(uint64_t fp);                        // 幽灵命中后删除，返回是否存在
+    bool contains(uint64_t fp) const { return index_.contains(fp); }
+    bool mayContain(uint64_t fp) const;             // 无锁预判，返回false时一定不在幽灵缓存中
+    void resize(size_t capacity);                   // 改变容量，缩小时丢弃最旧的指纹，只在持有所属缓存的锁时调用
+    size_t size() const { return index_.size(); }
+    size_t capacity() const { return ring_.size(); }
+
+private:
+    static size_t filterSize(size_t capacity);      // 计数器个数，取不小于4倍容量的2的幂
+    void updateFilter(uint64_t fp, int delta);      // 只在持有所属缓存的锁时调用
+
+private:
+    static const uint8_t kCounterMax = 255;         // 计数器饱和后不再增减，只会带来误判不会漏判
+
+    std::vector<uint64_t> ring_;                    // 环形数组，0表示空位
+    size_t pos_;                                    // 下一个写入位置，即最旧的位置
+    FlatHashMap<uint64_t, uint32_t> index_;         // 指纹 -> 环形数组下标
+    size_t filterMask_;
+    std::vector<std::atomic<uint8_t>> filter_;      // 计数布隆过滤器，每个指纹对应两个计数器
+};
+
+template<typename Key>
+uint64_t ArcGhostList::fingerprint(const Key& key)
+{
+    // 指纹即CacheHash，与key索引、分片使用同一个哈希值
+    return fingerprintOf(CacheHash<Key>()(key));
+}
+
+inline void ArcGhostList::add(uint64_t fp)
+{
+    if(ring_.empty()) return;
+    erase(fp);
+    // 覆盖最旧的位置
+    if(ring_[pos_] != 0){
+        updateFilter(ring_[pos_], -1);
+        index_.erase(ring_[pos_]);
+    }
+    ring_[pos_] = fp;
+    index_.insert(fp, static_cast<uint32_t>(pos_));
+    updateFilter(fp, 1);
+    pos_ = (pos_ + 1) % ring_.size();
+}
+
+inline bool ArcGhostList::erase(uint64_t fp)
+{
+    uint32_t* slot = index_.find(fp);
+    if(slot == nullptr) return false;
+    ring_[*slot] = 0;
+    index_.erase(fp);
+    updateFilter(fp, -1);
+    return true;
+}
+
+inline bool ArcGhostList::mayContain(uint64_t fp) const
+{
+    return filter_[fp & filterMask_].load(std::memory_order_relaxed) != 0
+        && filter_[(fp >> 32) & filterMask_].load(std::memory_order_relaxed) != 0;
+}
+
+inline void ArcGhostList::resize(size_t capacity)
+{
+    if(capacity == ring_.size()) return;
+    // 从最旧的位置开始按淘汰顺序取出指纹，只保留最新的capacity个
+    std::vector<uint64_t> kept;
+    kept.reserve(index_.size());
+    for(size_t i = 0; i < ring_.size(); i++){
+        uint64_t fp = ring_[(pos_ + i) % ring_.size()];
+        if(fp != 0) kept.push_back(fp);
+    }
+    size_t drop = kept.size() > capacity ? kept.size() - capacity : 0;
+    for(size_t i = 0; i < drop; i++){
+        updateFilter(kept[i], -1);
+    }
+    ring_.assign(capacity, 0);
+    index_.clear();
+    index_.reserve(capacity);
+    for(size_t i = drop; i < kept.size(); i++){
+        ring_[i - drop] = kept[i];
+        index_.insert(kept[i], static_cast<uint32_t>(i - drop));
+    }
+    pos_ = capacity == 0 ? 0 : (kept.size() - drop) % capacity;
+}
+
+inline size_t ArcGhostList::filterSize(size_t capacity)
+{
+    size_t size = 64;
+    while(size < capacity * 4) size <<= 1;
+    return size;
+}
+
+inline void ArcGhostList::updateFilter(uint64_t fp, int delta)
+{
+    // 写操作已由外部锁串行化，这里只需保证读线程看到的是完整的计数值
+    size_t positions[2] = { fp & filterMask_, (fp >> 32) & filterMask_ };
+    for(size_t pos : positions){
+        uint8_t count = filter_[pos].load(std::memory_order_relaxed);
+        if(count == kCounterMax) continue;
+        filter_[pos].store(static_cast<uint8_t>(count + delta), std::memory_order_relaxed);
+    }
+}
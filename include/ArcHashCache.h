@@ -1,25 +1,29 @@
 #pragma once
 
 #include <vector>
-#include <memory>
 #include <thread>
 #include <cmath>
+#include <memory>
 
 #include "ArcCache.h"
+#include "ShardArray.h"
+#include "SliceRebalancer.h"
+#include "SliceTable.h"
 
-template <typename Key, typename Value>
+// 分片数向上取整为2的幂，key的哈希高位按掩码选分片；Hash为可替换的哈希函数，默认CacheHash；Lock为各分片的锁策略，默认std::mutex
+// 分片保存在SliceTable中，运行时可以用resize改变总容量、用reshard改变分片数，缓存中的数据不会丢失
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>, typename Lock = std::mutex>
 class ArcHashCache : public cachePolicy<Key, Value>
 {
 public:
-    ArcHashCache(size_t capacity, int sliceNum, size_t transformThreshold)
-    :capacity_(capacity)
-    ,sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
-    ,transformThreshold_(transformThreshold)
+    // rebalance为true时按各分片的未命中数在分片之间调配容量，见SliceRebalancer
+    ArcHashCache(size_t capacity, int sliceNum, size_t transformThreshold, double promotionRatio = 0, bool rebalance = false)
+    :transformThreshold_(transformThreshold)
+    ,promotionRatio_(promotionRatio)
+    ,ArcSlice_(capacity, sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency(),
+               [this](ShardArray<SliceType>& chunk, size_t count, size_t sliceSize){ makeSlices(chunk, count, sliceSize); })
     {
-        size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
-        for (int i=0;i<sliceNum_;i++) {
-            ArcSlice_.emplace_back(new ArcCache<Key, Value>(sliceSize, transformThreshold_));
-        }
+        if(rebalance) rebalancer_.reset(new SliceRebalancer(ArcSlice_.sliceNum(), ArcSlice_.sliceCapacity()));
     }
 
 public:
@@ -27,41 +31,91 @@ public:
     bool get(Key key, Value& value);
     Value get(Key key);
 
+    // 改变总容量，减小时超出的条目由各分片在之后的插入中逐步淘汰；开启再平衡时各分片的容量重新平均分配
+    void resize(size_t capacity);
+    // 改变分片数（向上取整为2的幂），条目在之后的访问中逐步迁移，见SliceTable；上一次迁移未完成或开启了再平衡时返回false
+    bool reshard(int sliceNum);
+
+    int sliceNum() const { return static_cast<int>(ArcSlice_.sliceNum()); }
+    size_t sliceIndex(const Key& key) const { return ArcSlice_.indexOf(cacheHashOf(Hash(), key)); } // key所在的分片，供统计分片负载
+
 private:
+    using SliceType = ArcCache<Key, Value, Index, Hash, Lock>;
+
     size_t ArcHashValue(Key key);
+    void makeSlices(ShardArray<SliceType>& chunk, size_t count, size_t sliceSize);
+    void rebalanceSlices();
 
 private:
-    size_t capacity_;
-    int sliceNum_;
     size_t transformThreshold_;
-    std::vector<std::unique_ptr<ArcCache<Key,Value>>> ArcSlice_;
+    double promotionRatio_;
+    SliceTable<Key, Value, SliceType> ArcSlice_;
+    std::unique_ptr<SliceRebalancer> rebalancer_;  // 未开启再平衡时为空
 };
 
-template<typename Key, typename Value>
-void ArcHashCache<Key,Value>::put(Key key,Value value)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void ArcHashCache<Key, Value, Index, Hash, Lock>::put(Key key,Value value)
 {
-    size_t sliceIndex = ArcHashValue(key) % sliceNum_;
-    ArcSlice_[sliceIndex]->put(key,value);
+    // key的哈希只算一次：高位选slice，完整的哈希值传给slice使用
+    size_t hash = ArcHashValue(key);
+    ArcSlice_.put(key, value, hash);
 }
 
-template<typename Key, typename Value>
-bool ArcHashCache<Key,Value>::get(Key key, Value& value)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcHashCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value)
 {
-    size_t sliceIndex = ArcHashValue(key) % sliceNum_;
-    return ArcSlice_[sliceIndex]->get(key,value);
+    size_t hash = ArcHashValue(key);
+    bool hit = ArcSlice_.get(key, value, hash);
+    // 开启再平衡时不会reshard，分片下标不变
+    if(rebalancer_ && rebalancer_->record(ArcSlice_.indexOf(hash), hit)) rebalanceSlices();
+    return hit;
 }
 
-template<typename Key,typename Value>
-Value ArcHashCache<Key,Value>::get(Key key)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+Value ArcHashCache<Key, Value, Index, Hash, Lock>::get(Key key)
 {
     Value value{};
     get(key, value);
     return value;
 }
 
-template<typename Key, typename Value>
-size_t ArcHashCache<Key,Value>::ArcHashValue(Key key)
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+size_t ArcHashCache<Key, Value, Index, Hash, Lock>::ArcHashValue(Key key)
+{
+    return cacheHashOf(Hash(), key);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void ArcHashCache<Key, Value, Index, Hash, Lock>::resize(size_t capacity)
+{
+    ArcSlice_.resize(capacity);
+    if(rebalancer_){
+        rebalancer_->reset(ArcSlice_.sliceCapacity(),
+            [this](size_t i, size_t sliceSize){ ArcSlice_[i].setCapacity(sliceSize); });
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool ArcHashCache<Key, Value, Index, Hash, Lock>::reshard(int sliceNum)
+{
+    // 再平衡的计数和容量预算按构造时的分片数分配
+    if(rebalancer_) return false;
+    return ArcSlice_.reshard(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency(),
+        [this](ShardArray<SliceType>& chunk, size_t count, size_t sliceSize){ makeSlices(chunk, count, sliceSize); });
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void ArcHashCache<Key, Value, Index, Hash, Lock>::makeSlices(ShardArray<SliceType>& chunk, size_t count, size_t sliceSize)
 {
-    std::hash<Key> hashFunc;
-    return hashFunc(key);
-}
\ No newline at end of file
+    for(size_t i = 0; i < count; i++){
+        chunk.emplace_back(sliceSize, transformThreshold_, promotionRatio_);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void ArcHashCache<Key, Value, Index, Hash, Lock>::rebalanceSlices()
+{
+    rebalancer_->rebalance(
+        [this](size_t i){ return ArcSlice_[i].size(); },
+        [this](size_t i, size_t capacity){ ArcSlice_[i].setCapacity(capacity); });
+}
@@ -1,233 +1,306 @@
 #pragma once
 
-#include <unordered_map>
-#include <map>
-#include <list>
+#include <vector>
 
 #include "ArcCacheNode.h"
+#include "ArcGhostList.h"
+#include "KeyIndex.h"
 
+// 频次桶：同一访问频次的节点组成侵入式双向链表，头部最旧、尾部最新
+// 桶之间按频次升序组成双向循环链表，哨兵之后的第一个桶即为最小频次桶
 template<typename Key, typename Value>
+struct ArcFreqBucket
+{
+    size_t freq;
+    ArcFreqBucket* prev;
+    ArcFreqBucket* next;
+    ArcNode<Key, Value>* head;
+    ArcNode<Key, Value>* tail;
+
+    ArcFreqBucket() : freq(0), prev(this), next(this), head(nullptr), tail(nullptr) {}
+    bool empty() const { return head == nullptr; }
+};
+
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
 class ArcLfu
 {
 public:
     using NodeType = ArcNode<Key, Value>;
-    using Nodeptr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, Nodeptr>;
-    using FreqMap = std::map<size_t, std::list<Nodeptr>>;
+    using Nodeptr = NodeType*;
+    using NodeMap = typename Index::template Map<Key, Nodeptr, Hash>;
+    using Bucket = ArcFreqBucket<Key, Value>;
 
     explicit ArcLfu(size_t capacity, size_t transformThreshold)
     : capacity_(capacity)
     , transformThreshold_(transformThreshold)
-    , minFreq_(1)
-    , ghostCapacity_(capacity)
-    {
-        initializeLists();
-    }
+    , mainCache_(capacity)
+    , ghost_(capacity)
+    {}
+
+    ~ArcLfu();
 
-    bool put(Key key, Value value);      // 向缓存中添加数据
-    bool get(Key key, Value& value);     // 判断数据是否存在于缓存中
-    Value get(Key key);                  // 从缓存中得到数据
-    bool contain(Key key);               // 检查缓存是否包含某个键
-    bool eraseGhost(Key key);            // 删除幽灵缓存包含的某个键
+    // hash均为cacheHashOf(Hash(), key)，由ArcCache算好传入
+    bool put(Key key, Value value, size_t hash);   // 向缓存中添加数据
+    bool get(Key key, Value& value, size_t hash);  // 判断数据是否存在于缓存中
+    bool contain(Key key, size_t hash);            // 检查缓存是否包含某个键
+    bool eraseGhost(uint64_t fp);                  // 删除幽灵缓存包含的某个指纹
+    bool ghostMayContain(uint64_t fp) const { return ghost_.mayContain(fp); } // 无锁预判幽灵缓存是否可能包含该指纹
     void increaseCapacity();             // 增加缓存容量
     bool decreaseCapacity();             // 减小缓存容量
+    void setCapacity(size_t capacity, size_t ghostCapacity); // 直接设置容量，超出的条目分摊到之后的插入中淘汰；幽灵缓存改为ghostCapacity
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return mainCache_.size(); }
+
+    // 供分片迁移使用：移出节点时不记入幽灵缓存
+    bool peek(const Key& key, size_t hash, Value& value);  // 读取value，不改变访问顺序和频次
+    bool take(const Key& key, size_t hash, Value& value);  // 移出节点并取回value
+    template<typename Fn>
+    bool forEachKey(size_t& cursor, size_t limit, Fn fn);  // 分批遍历主缓存，fn(key, hash)，见ArcNodePool::forEachFrom
 
 private:
-    void initializeLists();                                     // 初始化幽灵缓存链表
-    bool updateExistingNode(Nodeptr node, const Value& value);  // 更新已存在节点
-    bool addNewNode(const Key& key, const Value& value);        // 增加新节点
-    void updateNodeFrequency(Nodeptr node);                     // 更新节点的访问频次
+    bool updateExistingNode(NodeType* node, const Value& value); // 更新已存在节点
+    bool addNewNode(const Key& key, const Value& value, size_t hash); // 增加新节点
+    void updateNodeFrequency(NodeType* node);                   // 更新节点的访问频次
     void evictLeastFrequent();                                  // 淘汰掉访问频次最低的节点
-    void removeFromGhost(Nodeptr node);                         // 从幽灵缓存中移除节点
-    void addToGhost(Nodeptr node);                              // 将节点添加到幽灵缓存中
-    void removeOldestGhost();                                   // 移除幽灵缓存中最旧的节点
+    Bucket* acquireBucket(size_t freq, Bucket* prev);           // 在prev之后插入频次为freq的桶
+    void releaseBucket(Bucket* bucket);                         // 摘除空桶并回收
+    void addToBucket(Bucket* bucket, NodeType* node);           // 节点加入桶尾部
+    void removeFromBucket(NodeType* node);                      // 节点从所属桶中摘除
 
 private:
+    static const size_t kShrinkStep = 2;  // 容量减小后，每次设置容量或插入新节点时最多淘汰的节点数
+
     size_t capacity_;                // 主缓存容量
-    size_t ghostCapacity_;           // 幽灵缓存容量
     size_t transformThreshold_;      // 转换阈值
-    size_t minFreq_;                 // 最小访问频次
-    
+
     NodeMap mainCache_;              // 主缓存
-    NodeMap ghostCache_;             // 幽灵缓存
-    FreqMap freqMap_;                // 频次映射
+    ArcGhostList ghost_;             // 幽灵缓存，只保存被淘汰key的指纹
+    ArcNodePool<Key, Value> pool_;
 
-    Nodeptr ghostHead_;              // 幽灵缓存头节点
-    Nodeptr ghostTail_;              // 幽灵缓存尾节点
+    Bucket bucketList_;              // 频次桶链表哨兵
+    std::vector<Bucket*> freeBuckets_; // 回收的空桶，复用以避免反复分配
 };
 
-template<typename Key, typename Value>
-bool ArcLfu<Key, Value>::put(Key key, Value value){
+template<typename Key, typename Value, typename Index, typename Hash>
+ArcLfu<Key, Value, Index, Hash>::~ArcLfu(){
+    Bucket* bucket = bucketList_.next;
+    while(bucket != &bucketList_){
+        Bucket* next = bucket->next;
+        delete bucket;
+        bucket = next;
+    }
+    for(Bucket* freeBucket : freeBuckets_){
+        delete freeBucket;
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::put(Key key, Value value, size_t hash){
     // 向缓存中添加元素，如果存在于主缓存中进行更新，否则添加新的节点
     // todo是否需要判断是否命中幽灵缓存？
     if(capacity_ == 0) return false;
-    auto it = mainCache_.find(key);
-    if(it != mainCache_.end()){
-        return updateExistingNode(it->second, value);
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node != nullptr){
+        return updateExistingNode(*node, value);
     }
-    return addNewNode(key, value);
+    return addNewNode(key, value, hash);
 }
 
-template<typename Key, typename Value>
-bool ArcLfu<Key, Value>::get(Key key, Value& value){
-    // 判断是否存在于主缓存中，是的话进行更新
-    auto it = mainCache_.find(key);
-    if(it != mainCache_.end()){
-        updateExistingNode(it->second, value);
-        value = it->second->getValue();
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::get(Key key, Value& value, size_t hash){
+    // 判断是否存在于主缓存中，是的话更新访问频次
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node != nullptr){
+        updateNodeFrequency(*node);
+        value = (*node)->getValue();
         return true;
     }
     return false;
 }
 
-template<typename Key, typename Value>
-Value ArcLfu<Key, Value>::get(Key key){
-    Value value{};
-    get(key, value);
-    return value;
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::contain(Key key, size_t hash){
+    return mainCache_.find(key, hash) != nullptr;
 }
 
-template<typename Key, typename Value>
-bool ArcLfu<Key, Value>::contain(Key key){
-    return mainCache_.find(key)!=mainCache_.end();
-}
-
-template<typename Key, typename Value>
-bool ArcLfu<Key, Value>::eraseGhost(Key key){
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::eraseGhost(uint64_t fp){
     // 在幽灵缓存中删除某个数据
-    auto it = ghostCache_.find(key);
-    if(it != ghostCache_.end()){
-        removeFromGhost(it->second);
-        ghostCache_.erase(it);
-        return true;
-    }
-    return false;
+    return ghost_.erase(fp);
 }
 
-template<typename Key, typename Value>
-void ArcLfu<Key, Value>::increaseCapacity(){
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLfu<Key, Value, Index, Hash>::increaseCapacity(){
     // 增加主缓存容量
     ++capacity_;
 }
 
-template<typename Key, typename Value>
-bool ArcLfu<Key, Value>::decreaseCapacity(){
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::decreaseCapacity(){
     // 减小主缓存容量
     if(capacity_ <= 0) return false;
-    if(mainCache_.size() == capacity_){
+    if(mainCache_.size() >= capacity_){
         evictLeastFrequent();
     }
     --capacity_;
     return true;
 }
 
-template<typename Key, typename Value>
-void ArcLfu<Key, Value>::initializeLists(){
-    // 初始化，定义幽灵缓存的头尾节点
-    ghostHead_ = std::make_shared<NodeType>();
-    ghostTail_ = std::make_shared<NodeType>();
-    ghostHead_->next_ = ghostTail_;
-    ghostTail_->prev_ = ghostHead_;
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLfu<Key, Value, Index, Hash>::setCapacity(size_t capacity, size_t ghostCapacity){
+    capacity_ = capacity;
+    ghost_.resize(ghostCapacity);
+    for(size_t i = 0; i < kShrinkStep && mainCache_.size() > capacity_; i++){
+        evictLeastFrequent();
+    }
+    // 容量为0时put直接返回，不会再有插入来淘汰剩余节点
+    if(capacity_ == 0){
+        while(mainCache_.size() > 0) evictLeastFrequent();
+    }
 }
 
-template<typename Key, typename Value>
-bool ArcLfu<Key, Value>::updateExistingNode(Nodeptr node, const Value& value){
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::peek(const Key& key, size_t hash, Value& value){
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node == nullptr) return false;
+    value = (*node)->getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::take(const Key& key, size_t hash, Value& value){
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node == nullptr) return false;
+    NodeType* taken = *node;
+    value = taken->getValue();
+    Bucket* bucket = taken->bucket_;
+    removeFromBucket(taken);
+    if(bucket->empty()){
+        releaseBucket(bucket);
+    }
+    mainCache_.erase(key, hash);
+    pool_.release(taken);
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+template<typename Fn>
+bool ArcLfu<Key, Value, Index, Hash>::forEachKey(size_t& cursor, size_t limit, Fn fn){
+    return pool_.forEachFrom(cursor, limit, [&fn](const NodeType& node){ fn(node.getKey(), node.getHash()); });
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::updateExistingNode(NodeType* node, const Value& value){
     // 更新主缓存中的某个节点
     node->setValue(value);
     updateNodeFrequency(node);
     return true;
 }
 
-template<typename Key, typename Value>
-bool ArcLfu<Key, Value>::addNewNode(const Key& key, const Value& value){
-    // 在主缓存中添加新的节点
-    if(mainCache_.size() == capacity_){
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLfu<Key, Value, Index, Hash>::addNewNode(const Key& key, const Value& value, size_t hash){
+    // 在主缓存中添加新的节点，新节点进入频次为1的桶；容量刚减小时可能超出多个，每次只多淘汰kShrinkStep个
+    for(size_t i = 0; i < kShrinkStep && mainCache_.size() >= capacity_; i++){
         evictLeastFrequent();
     }
-    Nodeptr newNode = std::make_shared<ArcNode<Key, Value>>(key, value);
-    mainCache_[key] = newNode;
-    freqMap_[1].push_back(newNode);
-    minFreq_ = 1;
+    NodeType* newNode = pool_.allocate(key, value, hash);
+    mainCache_.insert(key, newNode, hash);
+    Bucket* first = bucketList_.next;
+    if(first == &bucketList_ || first->freq != 1){
+        first = acquireBucket(1, &bucketList_);
+    }
+    addToBucket(first, newNode);
     return true;
 }
 
-template<typename Key, typename Value>
-void ArcLfu<Key, Value>::updateNodeFrequency(Nodeptr node){
-    // 更新节点的频次
-    size_t oldFreq = node->getAccessCount();
-    node->increamentAccessCount();
-    size_t newFreq = node->getAccessCount();
-
-    auto& oldList = freqMap_[oldFreq];
-    oldList.remove(node);
-    if(oldList.empty()){
-        freqMap_.erase(oldFreq);
-        if(oldFreq == minFreq_){
-            minFreq_ = newFreq;
-        }
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLfu<Key, Value, Index, Hash>::updateNodeFrequency(NodeType* node){
+    // 节点移动到相邻的freq+1桶，不存在时紧跟当前桶创建，全程O(1)
+    Bucket* oldBucket = node->bucket_;
+    size_t newFreq = oldBucket->freq + 1;
+    Bucket* newBucket = oldBucket->next;
+    if(newBucket == &bucketList_ || newBucket->freq != newFreq){
+        newBucket = acquireBucket(newFreq, oldBucket);
     }
-    if(freqMap_.find(newFreq) == freqMap_.end()){
-        freqMap_[newFreq] = std::list<Nodeptr>();
+    removeFromBucket(node);
+    addToBucket(newBucket, node);
+    node->increamentAccessCount();
+    if(oldBucket->empty()){
+        releaseBucket(oldBucket);
     }
-    freqMap_[newFreq].push_back(node);
 }
 
-template<typename Key, typename Value>
-void ArcLfu<Key, Value>::evictLeastFrequent(){
-    // 删掉最小频率的节点
-    if(freqMap_.empty()) return;
-    // revise
-    auto& minFreqList = freqMap_[minFreq_];
-    if(minFreqList.empty()) return;
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLfu<Key, Value, Index, Hash>::evictLeastFrequent(){
+    // 淘汰最小频次桶中最旧的节点
+    Bucket* minBucket = bucketList_.next;
+    if(minBucket == &bucketList_) return;
 
-    Nodeptr leastNode = minFreqList.front();
-    minFreqList.pop_front();
-    if(minFreqList.empty()){
-        freqMap_.erase(minFreq_);
-        if(!freqMap_.empty()){
-            minFreq_ = freqMap_.begin()->first;
-        }
-    }
-    if(ghostCache_.size() >= ghostCapacity_){
-        removeOldestGhost();
+    NodeType* leastNode = minBucket->head;
+    removeFromBucket(leastNode);
+    if(minBucket->empty()){
+        releaseBucket(minBucket);
     }
-    addToGhost(leastNode);
-    mainCache_.erase(leastNode->getKey());
+    // 幽灵缓存只记录指纹，节点从主缓存删除后归还节点池，value随之释放
+    size_t hash = leastNode->getHash();
+    ghost_.add(ArcGhostList::fingerprintOf(hash));
+    mainCache_.erase(leastNode->key_, hash);
+    pool_.release(leastNode);
 }
 
-template<typename Key, typename Value>
-void ArcLfu<Key, Value>::removeFromGhost(Nodeptr node){
-    // 幽灵缓存中删除节点
-    if(!node->prev_.expired() && node->next_){
-        auto prevNode = node->prev_.lock();
-        auto nextNode = node->next_;
-        prevNode->next_ = nextNode;
-        nextNode->prev_ = prevNode;
-        node->next_ = nullptr;
-        node->prev_.reset();
+template<typename Key, typename Value, typename Index, typename Hash>
+typename ArcLfu<Key, Value, Index, Hash>::Bucket* ArcLfu<Key, Value, Index, Hash>::acquireBucket(size_t freq, Bucket* prev){
+    Bucket* bucket = nullptr;
+    if(freeBuckets_.empty()){
+        bucket = new Bucket();
+    }else{
+        bucket = freeBuckets_.back();
+        freeBuckets_.pop_back();
     }
+    bucket->freq = freq;
+    bucket->head = nullptr;
+    bucket->tail = nullptr;
+    bucket->prev = prev;
+    bucket->next = prev->next;
+    prev->next->prev = bucket;
+    prev->next = bucket;
+    return bucket;
 }
 
-template<typename Key, typename Value>
-void ArcLfu<Key, Value>::addToGhost(Nodeptr node){
-    // 幽灵缓存中添加节点
-    node->next_ = ghostTail_;
-    auto lastNode = ghostTail_->prev_.lock();
-    node->prev_ = lastNode;
-    if(lastNode){
-        lastNode->next_=node;
-    }
-    ghostTail_->prev_ = node;
-    ghostCache_[node->getKey()] = node;
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLfu<Key, Value, Index, Hash>::releaseBucket(Bucket* bucket){
+    bucket->prev->next = bucket->next;
+    bucket->next->prev = bucket->prev;
+    freeBuckets_.push_back(bucket);
 }
 
-template<typename Key, typename Value>
-void ArcLfu<Key, Value>::removeOldestGhost(){
-    // 删除幽灵缓存中最旧的数据
-    Nodeptr oldestGhost = ghostHead_->next_;
-    if(oldestGhost != ghostTail_){
-        removeFromGhost(oldestGhost);
-        ghostCache_.erase(oldestGhost->getKey());
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLfu<Key, Value, Index, Hash>::addToBucket(Bucket* bucket, NodeType* node){
+    node->bucket_ = bucket;
+    node->next_ = nullptr;
+    node->prev_ = bucket->tail;
+    if(bucket->tail){
+        bucket->tail->next_ = node;
+    }else{
+        bucket->head = node;
     }
+    bucket->tail = node;
 }
 
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLfu<Key, Value, Index, Hash>::removeFromBucket(NodeType* node){
+    Bucket* bucket = node->bucket_;
+    if(node->prev_){
+        node->prev_->next_ = node->next_;
+    }else{
+        bucket->head = node->next_;
+    }
+    if(node->next_){
+        node->next_->prev_ = node->prev_;
+    }else{
+        bucket->tail = node->prev_;
+    }
+    node->prev_ = nullptr;
+    node->next_ = nullptr;
+    node->bucket_ = nullptr;
+}
@@ -1,247 +1,257 @@
 #pragma once
 
-#include <unordered_map>
-
 #include "ArcCacheNode.h"
+#include "ArcGhostList.h"
+#include "KeyIndex.h"
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
 class ArcLru
 {
 public:
     using NodeType = ArcNode<Key, Value>;
-    using Nodeptr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, Nodeptr>;
+    using Nodeptr = NodeType*;
+    using NodeMap = typename Index::template Map<Key, Nodeptr, Hash>;
 
-    explicit ArcLru(size_t capacity, size_t transformThreshold)
+    // promotionRatio：命中的节点距链表头不超过capacity * promotionRatio个位置时不移动，0表示每次命中都移动
+    explicit ArcLru(size_t capacity, size_t transformThreshold, double promotionRatio = 0)
     : capacity_(capacity)
-    , ghostCapacity_(capacity)
     , transformThreshold_(transformThreshold)
+    , promotionRatio_(promotionRatio > 1 ? 1 : (promotionRatio > 0 ? promotionRatio : 0))
+    , generation_(0)
+    , promoteWindow_(0)
+    , mainCache_(capacity)
+    , ghost_(capacity)
     {
         initializeLists();
+        updatePromoteWindow();
     }
 
-    bool put(Key key, Value value);                         // 向缓存中添加数据
-    bool get(Key key, Value& value, bool& shouldTransform); // 判断数据是否存在于缓存中
-    Value get(Key key);                                     // 从缓存中得到数据
+    // hash均为cacheHashOf(Hash(), key)，由ArcCache算好传入
+    bool put(Key key, Value value, size_t hash);            // 向缓存中添加数据
+    bool get(Key key, Value& value, bool& shouldTransform, size_t hash); // 判断数据是否存在于缓存中
 
-    bool eraseGhost(Key key);                               // 删除幽灵数据包含的某个键
+    bool eraseGhost(uint64_t fp);                           // 删除幽灵数据包含的某个指纹
+    bool ghostMayContain(uint64_t fp) const { return ghost_.mayContain(fp); } // 无锁预判幽灵缓存是否可能包含该指纹
     void increaseCapacity();                                // 增加缓存容量
     bool decreaseCapacity();                                // 减小缓存容量
+    void setCapacity(size_t capacity, size_t ghostCapacity); // 直接设置容量，超出的条目分摊到之后的插入中淘汰；幽灵缓存改为ghostCapacity
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return mainCache_.size(); }
+
+    // 供分片迁移使用：移出节点时不记入幽灵缓存
+    bool contain(const Key& key, size_t hash) { return mainCache_.find(key, hash) != nullptr; }
+    bool peek(const Key& key, size_t hash, Value& value);  // 读取value，不改变访问顺序和计数
+    bool take(const Key& key, size_t hash, Value& value);  // 移出节点并取回value
+    template<typename Fn>
+    bool forEachKey(size_t& cursor, size_t limit, Fn fn);  // 分批遍历主缓存，fn(key, hash)，见ArcNodePool::forEachFrom
 
 private:
     void initializeLists();                                     // 初始化缓存链表
-    bool updateExistingNode(Nodeptr node, const Value& value);  // 更新已存在节点
-    bool addNewNode(const Key& key, const Value& value);        // 增加新节点
-    bool updateNodeAccess(Nodeptr node);                        // 更新节点
-    void moveToFront(Nodeptr node);                             // 将节点移动到链表头
-    void addToFront(Nodeptr node);                              // 在链表头增加新节点
+    bool updateExistingNode(NodeType* node, const Value& value); // 更新已存在节点
+    bool addNewNode(const Key& key, const Value& value, size_t hash); // 增加新节点
+    bool updateNodeAccess(NodeType* node);                      // 更新节点
+    void moveToFront(NodeType* node);                           // 将节点移动到链表头
+    void addToFront(NodeType* node);                            // 在链表头增加新节点
     void evictLeastRecent();                                    // 淘汰最旧未使用节点
-    void removeFromMain(Nodeptr node);                          // 在主缓存中移除节点
-    void removeFromGhost(Nodeptr node);                         // 在幽灵缓存中移除节点
-    void addToGhost(Nodeptr node);                              // 在幽灵缓存中添加节点
-    void removeOldestGhost();                                   // 在幽灵缓存中移除节点
+    void removeFromMain(NodeType* node);                        // 在主缓存中移除节点
+    void updatePromoteWindow();                                 // 容量变化后重新计算节流窗口
 
 private:
+    static const size_t kShrinkStep = 2;  // 容量减小后，每次设置容量或插入新节点时最多淘汰的节点数
+
     size_t capacity_;
-    size_t ghostCapacity_;
     size_t transformThreshold_; // 转换阈值
+    double promotionRatio_;
+    // 提升节流：节点移到链表头时记下代数，之后每有一个节点移到链表头代数加一；
+    // 代数差小于promoteWindow_，说明排在它前面的节点少于promoteWindow_个，命中时不必移动
+    uint32_t generation_;
+    uint32_t promoteWindow_;
 
     NodeMap mainCache_;  // 主缓存
-    NodeMap ghostCache_; // 幽灵缓存
+    ArcGhostList ghost_; // 幽灵缓存，只保存被淘汰key的指纹
+    ArcNodePool<Key, Value> pool_;
 
-    Nodeptr mainHead_;   // 主缓存头节点
-    Nodeptr mainTail_;   // 主缓存尾节点
-
-    Nodeptr ghostHead_;  // 幽灵缓存头节点
-    Nodeptr ghostTail_;  // 幽灵缓存尾节点
+    NodeType mainHead_;  // 主缓存头节点
+    NodeType mainTail_;  // 主缓存尾节点
 };
 
-template<typename Key, typename Value>
-bool ArcLru<Key, Value>::put(Key key, Value value)
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::put(Key key, Value value, size_t hash)
 {
     if(capacity_ == 0) return false;
-    auto it = mainCache_.find(key);
-    if(it != mainCache_.end()){
-        return updateExistingNode(it->second, value);
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node != nullptr){
+        return updateExistingNode(*node, value);
     }
-    return addNewNode(key, value);
+    return addNewNode(key, value, hash);
 }
 
-template<typename Key, typename Value>
-bool ArcLru<Key, Value>::get(Key key, Value& value, bool& shouldTransform)
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::get(Key key, Value& value, bool& shouldTransform, size_t hash)
 {
-    auto it=mainCache_.find(key);
-    if(it != mainCache_.end()){
-        shouldTransform = updateNodeAccess(it->second);
-        value = it->second->getValue();
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node != nullptr){
+        shouldTransform = updateNodeAccess(*node);
+        value = (*node)->getValue();
         return true;
     }
     return false;
 }
 
-template<typename Key, typename Value>
-Value ArcLru<Key, Value>::get(Key key)
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::eraseGhost(uint64_t fp)
 {
-    Value value{};
-    get(key, value);
-    return value;
+    return ghost_.erase(fp);
 }
 
-template<typename Key, typename Value>
-bool ArcLru<Key, Value>::eraseGhost(Key key)
-{
-    auto it = ghostCache_.find(key);
-    if(it != ghostCache_.end()){
-        removeFromGhost(it->second);
-        ghostCache_.erase(it);
-        return true;
-    }
-    return false;
-}
-
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::increaseCapacity()
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::increaseCapacity()
 {
     ++capacity_;
+    updatePromoteWindow();
 }
 
-template<typename Key, typename Value>
-bool ArcLru<Key, Value>::decreaseCapacity()
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::decreaseCapacity()
 {
     if (capacity_ <= 0) return false;
-    if (mainCache_.size() == capacity_) {
+    if (mainCache_.size() >= capacity_) {
         evictLeastRecent();
     }
     --capacity_;
+    updatePromoteWindow();
     return true;
 }
 
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::initializeLists()
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::setCapacity(size_t capacity, size_t ghostCapacity)
+{
+    capacity_ = capacity;
+    ghost_.resize(ghostCapacity);
+    updatePromoteWindow();
+    for(size_t i = 0; i < kShrinkStep && mainCache_.size() > capacity_; i++){
+        evictLeastRecent();
+    }
+    // 容量为0时put直接返回，不会再有插入来淘汰剩余节点
+    if(capacity_ == 0){
+        while(mainCache_.size() > 0) evictLeastRecent();
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::peek(const Key& key, size_t hash, Value& value)
 {
-    mainHead_ = std::make_shared<NodeType>();
-    mainTail_ = std::make_shared<NodeType>();
-    mainHead_->next_ = mainTail_;
-    mainTail_->prev_ = mainHead_;
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node == nullptr) return false;
+    value = (*node)->getValue();
+    return true;
+}
 
-    ghostHead_ = std::make_shared<NodeType>();
-    ghostTail_ = std::make_shared<NodeType>();
-    ghostHead_->next_ = ghostTail_;
-    ghostTail_->prev_ = ghostHead_;
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::take(const Key& key, size_t hash, Value& value)
+{
+    Nodeptr* node = mainCache_.find(key, hash);
+    if(node == nullptr) return false;
+    NodeType* taken = *node;
+    value = taken->getValue();
+    removeFromMain(taken);
+    mainCache_.erase(key, hash);
+    pool_.release(taken);
+    return true;
 }
 
-template<typename Key, typename Value>
-bool ArcLru<Key, Value>::updateExistingNode(Nodeptr node, const Value& value)
+template<typename Key, typename Value, typename Index, typename Hash>
+template<typename Fn>
+bool ArcLru<Key, Value, Index, Hash>::forEachKey(size_t& cursor, size_t limit, Fn fn)
+{
+    return pool_.forEachFrom(cursor, limit, [&fn](const NodeType& node){ fn(node.getKey(), node.getHash()); });
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::initializeLists()
+{
+    mainHead_.next_ = &mainTail_;
+    mainTail_.prev_ = &mainHead_;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::updateExistingNode(NodeType* node, const Value& value)
 {
     node->setValue(value);
     moveToFront(node);
     return true;
 }
 
-template<typename Key, typename Value>
-bool ArcLru<Key, Value>::addNewNode(const Key& key, const Value& value)
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::addNewNode(const Key& key, const Value& value, size_t hash)
 {
-    if(mainCache_.size() >= capacity_){
+    // 容量刚减小时可能超出多个，每次只多淘汰kShrinkStep个
+    for(size_t i = 0; i < kShrinkStep && mainCache_.size() >= capacity_; i++){
         evictLeastRecent();
     }
-    Nodeptr newNode = std::make_shared<NodeType>(key, value);
-    mainCache_[key] = newNode;
+    NodeType* newNode = pool_.allocate(key, value, hash);
+    mainCache_.insert(key, newNode, hash);
     addToFront(newNode);
     return true;
 }
 
-template<typename Key, typename Value>
-bool ArcLru<Key, Value>::updateNodeAccess(Nodeptr node)
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ArcLru<Key, Value, Index, Hash>::updateNodeAccess(NodeType* node)
 {
     moveToFront(node);
     node->increamentAccessCount();
     return node->getAccessCount() >= transformThreshold_;
 }
 
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::moveToFront(Nodeptr node)
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::moveToFront(NodeType* node)
 {
-    if(!node->prev_.expired()&&node->next_){
-        auto lastNode = node->prev_.lock();
-        auto nextNode = node->next_;
-        nextNode->prev_ = lastNode;
-        lastNode->next_ = nextNode;
-        node->next_ = nullptr;
-    }
+    // 无符号减法，代数回绕后仍然正确
+    if(generation_ - node->stamp_ < promoteWindow_) return;
+    removeFromMain(node);
     addToFront(node);
 }
 
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::addToFront(Nodeptr node)
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::addToFront(NodeType* node)
 {
-    auto nextNode = mainHead_->next_;
+    NodeType* nextNode = mainHead_.next_;
     node->next_ = nextNode;
-    node->prev_ = mainHead_;
+    node->prev_ = &mainHead_;
     nextNode->prev_ = node;
-    mainHead_->next_ = node;
+    mainHead_.next_ = node;
+    node->stamp_ = ++generation_;
 }
 
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::evictLeastRecent()
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::evictLeastRecent()
 {
-    Nodeptr leastRecent = mainTail_->prev_.lock();
-    if(!leastRecent || leastRecent == mainHead_) return;
+    NodeType* leastRecent = mainTail_.prev_;
+    if(leastRecent == &mainHead_) return;
 
     removeFromMain(leastRecent);
 
-    if(ghostCache_.size() >= ghostCapacity_)
-    {
-        removeOldestGhost();
-    }
-    addToGhost(leastRecent);
-
-    mainCache_.erase(leastRecent->getKey());
+    // 幽灵缓存只记录指纹，节点从主缓存删除后归还节点池，value随之释放
+    size_t hash = leastRecent->getHash();
+    ghost_.add(ArcGhostList::fingerprintOf(hash));
+    mainCache_.erase(leastRecent->key_, hash);
+    pool_.release(leastRecent);
 }
 
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::removeFromMain(Nodeptr node)
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::removeFromMain(NodeType* node)
 {
-    if(!node->prev_.expired() && node->next_)
+    if(node->prev_ && node->next_)
     {
-        auto prevNode = node->prev_.lock();
-        auto nextNode = node->next_;
-        prevNode->next_ = nextNode;
-        nextNode->prev_ = prevNode;
+        node->prev_->next_ = node->next_;
+        node->next_->prev_ = node->prev_;
+        node->prev_ = nullptr;
         node->next_ = nullptr;
     }
 }
 
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::removeFromGhost(Nodeptr node)
-{
-    if(!node->prev_.expired() && node->next_)
-    {
-        auto prevNode = node->prev_.lock();
-        auto nextNode = node->next_;
-        prevNode->next_ = nextNode;
-        nextNode->prev_ = prevNode;
-        node->next_ = nullptr;
-    }
-}
-
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::addToGhost(Nodeptr node)
-{
-    node->accessCount_ = 1;
-    auto nextNode = ghostHead_->next_;
-    node->next_ = nextNode;
-    nextNode->prev_ = node;
-    node->prev_ = ghostHead_;
-    ghostHead_->next_ = node;
-
-    ghostCache_[node->getKey()] = node;
-}
-
-template<typename Key, typename Value>
-void ArcLru<Key, Value>::removeOldestGhost()
+template<typename Key, typename Value, typename Index, typename Hash>
+void ArcLru<Key, Value, Index, Hash>::updatePromoteWindow()
 {
-    Nodeptr oldestGhost = ghostTail_->prev_.lock();
-    if(!oldestGhost || oldestGhost == ghostHead_) return;
-    removeFromGhost(oldestGhost);
-    ghostCache_.erase(oldestGhost->getKey());
+    promoteWindow_ = static_cast<uint32_t>(capacity_ * promotionRatio_);
 }
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+// 缓存统一使用的64位哈希：std::hash的结果（整数key时为恒等映射）再经murmur3 fmix64打散，字符串按字节做wyhash式混合
+// 分片包装类只计算一次，高32位选分片，完整的哈希值传给分片；分片的哈希表用低位定位槽位，
+// 节点保存哈希值，淘汰时按哈希删除，整个流程不再重复计算key的哈希
+// 分片包装类和LruCache、LfuCache、ArcCache可以通过Hash模板参数换用其他哈希函数
+inline uint64_t cacheMix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+namespace CacheHashDetail{
+
+inline uint64_t read64(const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+inline uint64_t read32(const unsigned char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+// 64位乘法得到128位结果，a、b分别存放低64位和高64位
+inline void mul128(uint64_t& a, uint64_t& b)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = a & 0xffffffffULL, hb = b >> 32, lb = b & 0xffffffffULL;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+// 128位乘积的高低两半异或
+inline uint64_t mulFold(uint64_t a, uint64_t b)
+{
+    mul128(a, b);
+    return a ^ b;
+}
+
+// wyhash式的字节串哈希：每次吃16或48字节，用128位乘法折叠混合
+inline uint64_t hashBytes(const void* data, size_t len)
+{
+    static const uint64_t kSecret[4] = {
+        0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+        0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+    };
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t seed = mulFold(kSecret[0], kSecret[1]);
+    uint64_t a, b;
+    if(len <= 16){
+        if(len >= 4){
+            // 4~16字节：首尾各取两个可能重叠的4字节
+            size_t mid = (len >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + mid);
+            b = (read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+        }else if(len > 0){
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+            b = 0;
+        }else{
+            a = b = 0;
+        }
+    }else{
+        size_t i = len;
+        if(i > 48){
+            uint64_t see1 = seed, see2 = seed;
+            do{
+                seed = mulFold(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+                see1 = mulFold(read64(p + 16) ^ kSecret[2], read64(p + 24) ^ see1);
+                see2 = mulFold(read64(p + 32) ^ kSecret[3], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }while(i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while(i > 16){
+            seed = mulFold(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        // 最后16字节（可能与已处理部分重叠）
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+    a ^= kSecret[1];
+    b ^= seed;
+    mul128(a, b);
+    return mulFold(a ^ kSecret[0] ^ len, b ^ kSecret[1]);
+}
+
+} // namespace CacheHashDetail
+
+template<typename Key>
+struct CacheHash{
+    using is_avalanching = void;   // 输出已充分混合，哈希表直接使用，不再二次混合
+
+    size_t operator()(const Key& key) const{
+        return static_cast<size_t>(cacheMix64(static_cast<uint64_t>(std::hash<Key>()(key))));
+    }
+};
+
+template<>
+struct CacheHash<std::string>{
+    using is_avalanching = void;
+
+    size_t operator()(const std::string& key) const{
+        return static_cast<size_t>(CacheHashDetail::hashBytes(key.data(), key.size()));
+    }
+};
+
+// 哈希函数是否声明了is_avalanching，即输出的每一位都已充分混合
+template<typename Hash, typename = void>
+struct IsAvalanching : std::false_type {};
+
+template<typename Hash>
+struct IsAvalanching<Hash, typename Hash::is_avalanching> : std::true_type {};
+
+// 缓存内使用的哈希值：哈希函数声明了is_avalanching时直接使用，否则再经fmix64打散，哈希表内部与此一致
+template<typename Hash>
+inline size_t finishHash(size_t hash)
+{
+    return IsAvalanching<Hash>::value ? hash : static_cast<size_t>(cacheMix64(hash));
+}
+
+template<typename Hash, typename Key>
+inline size_t cacheHashOf(const Hash& hasher, const Key& key)
+{
+    return finishHash<Hash>(hasher(key));
+}
+
+// 分片数向上取整为2的幂，分片下标用掩码计算，不做整数除法
+inline size_t roundUpPow2(size_t n)
+{
+    size_t size = 1;
+    while(size < n) size <<= 1;
+    return size;
+}
+
+// 分片下标取哈希的高32位，与分片内哈希表使用的低位相互独立；shardMask为分片数减一
+inline size_t shardOf(size_t hash, size_t shardMask)
+{
+    return static_cast<size_t>(static_cast<uint64_t>(hash) >> 32) & shardMask;
+}
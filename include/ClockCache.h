@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "SharedSpinLock.h"
+#include "SwissHashMap.h"
+
+// CLOCK：条目存放在定长数组中，另有一个引用位字节数组，命中时只用relaxed原子写把引用位置1，get只加共享锁
+// 淘汰时时钟指针从当前位置扫描引用位，跳过的条目引用位清零，停在第一个引用位为0的条目上
+// 扫描借用SwissHashMap的控制字节分组，x86用SSE2、ARM用NEON一次检查16个引用位
+// 槽位同时保存key的哈希，淘汰时按哈希删除索引，不再重新计算
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
+class ClockCache : public cachePolicy<Key, Value>
+{
+public:
+    using Nodemap = typename Index::template Map<Key, uint32_t, Hash>;  // key到槽位下标的映射
+
+    ClockCache(int capacity)
+    : capacity_(capacity > 0 ? capacity : 0)
+    , hand_(0)
+    , keys_(capacity_)
+    , hashes_(capacity_)
+    , values_(capacity_)
+    , refBits_(capacity_)
+    , nodeMap_(capacity_)
+    {
+        static_assert(sizeof(std::atomic<uint8_t>) == 1, "reference bits are scanned as a byte array");
+        for(auto& bit : refBits_){
+            bit.store(0, std::memory_order_relaxed);
+        }
+        // 倒序压入，使低下标先被分配
+        freeSlots_.reserve(capacity_);
+        for(size_t i = capacity_; i > 0; i--){
+            freeSlots_.push_back(static_cast<uint32_t>(i - 1));
+        }
+    }
+
+    ~ClockCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+    void remove(Key key);
+
+    // hash为cacheHashOf(Hash(), key)，由分片包装类算好传入，分片内不再重复计算
+    void put(Key key, Value value, size_t hash);
+    bool get(Key key, Value& value, size_t hash);
+
+private:
+    uint32_t sweep();                          // 转动时钟指针，返回引用位为0的槽位
+    uint8_t* bits() { return reinterpret_cast<uint8_t*>(refBits_.data()); }
+
+private:
+    size_t capacity_;
+    size_t hand_;                              // 时钟指针
+    std::vector<Key> keys_;
+    std::vector<size_t> hashes_;               // 各槽位key的哈希
+    std::vector<Value> values_;
+    std::vector<std::atomic<uint8_t>> refBits_; // 引用位，1表示上次扫描后被访问过
+    std::vector<uint32_t> freeSlots_;          // 空闲槽位
+    Nodemap nodeMap_;
+    SharedSpinLock lock_;                      // get加共享锁，put、remove和扫描加独占锁
+};
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void ClockCache<Key, Value, Index, Hash>::put(Key key, Value value)
+{
+    put(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void ClockCache<Key, Value, Index, Hash>::put(Key key, Value value, size_t hash)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<SharedSpinLock> lock(lock_);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found != nullptr){
+        values_[*found] = value;
+        refBits_[*found].store(1, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t slot;
+    if(!freeSlots_.empty()){
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    }else{
+        slot = sweep();
+        nodeMap_.erase(keys_[slot], hashes_[slot]);
+    }
+    keys_[slot] = key;
+    hashes_[slot] = hash;
+    values_[slot] = value;
+    refBits_[slot].store(0, std::memory_order_relaxed);
+    nodeMap_.insert(key, slot, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ClockCache<Key, Value, Index, Hash>::get(Key key, Value& value)
+{
+    return get(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ClockCache<Key, Value, Index, Hash>::get(Key key, Value& value, size_t hash)
+{
+    SharedLockGuard<SharedSpinLock> lock(lock_);
+    const Nodemap& nodeMap = nodeMap_;
+    const uint32_t* found = nodeMap.find(key, hash);
+    if(found == nullptr) return false;
+    // 已经置位时不再写，避免热点条目所在的缓存行在核间来回失效
+    if(refBits_[*found].load(std::memory_order_relaxed) == 0){
+        refBits_[*found].store(1, std::memory_order_relaxed);
+    }
+    value = values_[*found];
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+Value ClockCache<Key, Value, Index, Hash>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void ClockCache<Key, Value, Index, Hash>::remove(Key key)
+{
+    size_t hash = cacheHashOf(Hash(), key);
+    std::lock_guard<SharedSpinLock> lock(lock_);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found != nullptr){
+        uint32_t slot = *found;
+        nodeMap_.erase(key, hash);
+        values_[slot] = Value();
+        refBits_[slot].store(0, std::memory_order_relaxed);
+        freeSlots_.push_back(slot);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+uint32_t ClockCache<Key, Value, Index, Hash>::sweep()
+{
+    // 只在持有独占锁且没有空闲槽位时调用，此时不会有并发的命中修改引用位，可以按普通字节数组批量读写
+    // 一圈之内所有引用位都会被清零，所以最多转一圈多就能找到
+    uint8_t* refBits = bits();
+    for(;;){
+        if(hand_ + SwissDetail::kGroupWidth <= capacity_){
+            SwissDetail::Group group(reinterpret_cast<const int8_t*>(refBits + hand_));
+            SwissDetail::BitMask clear = group.match(0);
+            if(clear.any()){
+                size_t offset = clear.lowest();
+                std::memset(refBits + hand_, 0, offset);
+                uint32_t victim = static_cast<uint32_t>(hand_ + offset);
+                hand_ = (victim + 1) % capacity_;
+                return victim;
+            }
+            std::memset(refBits + hand_, 0, SwissDetail::kGroupWidth);
+            hand_ = (hand_ + SwissDetail::kGroupWidth) % capacity_;
+            continue;
+        }
+        // 数组末尾不足一组的部分逐个检查
+        uint32_t slot = static_cast<uint32_t>(hand_);
+        hand_ = (hand_ + 1) % capacity_;
+        if(refBits[slot] == 0) return slot;
+        refBits[slot] = 0;
+    }
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
+#include "SharedSpinLock.h"
+
+// CLOCK-Pro（Jiang, Chen, Zhang）：在CLOCK的基础上区分冷热条目，抵抗一次性扫描
+// 常驻条目分为热、冷两类，另保留最多capacity个已淘汰冷条目的key作为测试条目（不保存value）
+// 所有条目按插入顺序组成一个环，三根指针沿环转动：
+//   冷指针淘汰未被访问的冷条目（转为测试条目），被访问过的冷条目升为热条目
+//   热指针把未被访问的热条目降为冷条目，使热条目不超过capacity - coldTarget_
+//   测试指针删除过期的测试条目，测试条目过期说明冷条目给得太多，coldTarget_减一
+// 测试条目再次put时说明冷条目给得太少，coldTarget_加一，并直接作为热条目插入
+// 命中只用relaxed原子写置引用位，get只加共享锁；环用LruSlab的0号链表表示
+template<typename Key, typename Value, typename Index = SwissIndex>
+class ClockProCache : public cachePolicy<Key, Value>
+{
+public:
+    using NodeSlab = LruSlab<Key, Value>;
+    using Nodemap = typename Index::template Map<Key, uint32_t>;  // key到节点下标的映射，包含测试条目
+
+    ClockProCache(int capacity)
+    : capacity_(capacity > 0 ? capacity : 0)
+    , coldTarget_(capacity_)
+    , hotCount_(0)
+    , coldCount_(0)
+    , testCount_(0)
+    , handHot_(NodeSlab::npos)
+    , handCold_(NodeSlab::npos)
+    , handTest_(NodeSlab::npos)
+    , slab_(capacity_ * 2 + 1)
+    , types_(capacity_ * 2 + 2, kCold)
+    , refBits_(capacity_ * 2 + 2)
+    , nodeMap_(capacity_ * 2)
+    {
+        for(auto& bit : refBits_){
+            bit.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~ClockProCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+    void remove(Key key);
+
+private:
+    enum Type : uint8_t { kHot = 0, kCold = 1, kTest = 2 };
+    static const size_t kClock = 0;     // slab中唯一的链表，即时钟环
+
+    uint32_t advance(uint32_t node) const;       // 沿环前进一步，跳过哨兵
+    uint32_t retreat(uint32_t node) const;       // 沿环后退一步，跳过哨兵
+    void addNode(const Key& key, const Value& value, Type type); // 插到热指针之前，即环上最新的位置
+    void deleteNode(uint32_t node);              // 从环中删除，指向它的指针后退一步
+    void evict();                                // 冷指针转动，直到常驻条目少于capacity
+    void runHandCold();                          // 冷指针处理当前条目并前进一步
+    void runHandHot();                           // 热指针处理当前条目并前进一步
+    void runHandTest();                          // 测试指针处理当前条目并前进一步
+    bool testAndClearRef(uint32_t node);
+
+private:
+    size_t capacity_;
+    size_t coldTarget_;        // 冷条目的目标个数，范围[1, capacity]
+    size_t hotCount_;
+    size_t coldCount_;
+    size_t testCount_;
+    uint32_t handHot_;
+    uint32_t handCold_;
+    uint32_t handTest_;
+    NodeSlab slab_;
+    std::vector<uint8_t> types_;                 // 节点下标 -> 条目类型
+    std::vector<std::atomic<uint8_t>> refBits_;  // 节点下标 -> 引用位
+    Nodemap nodeMap_;
+    SharedSpinLock lock_;                        // get加共享锁，put、remove和指针转动加独占锁
+};
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::put(Key key, Value value)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<SharedSpinLock> lock(lock_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found == nullptr){
+        addNode(key, value, kCold);
+        return;
+    }
+    uint32_t node = *found;
+    if(types_[node] != kTest){
+        slab_[node].setValue(value);
+        refBits_[node].store(1, std::memory_order_relaxed);
+        return;
+    }
+    // 测试期内再次访问：冷条目的目标个数加一，直接作为热条目重新插入
+    if(coldTarget_ < capacity_) ++coldTarget_;
+    --testCount_;
+    deleteNode(node);
+    addNode(key, value, kHot);
+}
+
+template<typename Key, typename Value, typename Index>
+bool ClockProCache<Key, Value, Index>::get(Key key, Value& value)
+{
+    SharedLockGuard<SharedSpinLock> lock(lock_);
+    const Nodemap& nodeMap = nodeMap_;
+    const uint32_t* found = nodeMap.find(key);
+    if(found == nullptr || types_[*found] == kTest) return false;
+    if(refBits_[*found].load(std::memory_order_relaxed) == 0){
+        refBits_[*found].store(1, std::memory_order_relaxed);
+    }
+    value = slab_[*found].getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index>
+Value ClockProCache<Key, Value, Index>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::remove(Key key)
+{
+    std::lock_guard<SharedSpinLock> lock(lock_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found == nullptr) return;
+    uint32_t node = *found;
+    switch(types_[node]){
+        case kHot: --hotCount_; break;
+        case kCold: --coldCount_; break;
+        case kTest: --testCount_; break;
+    }
+    deleteNode(node);
+}
+
+template<typename Key, typename Value, typename Index>
+uint32_t ClockProCache<Key, Value, Index>::advance(uint32_t node) const
+{
+    uint32_t next = slab_.next(node);
+    return next == NodeSlab::npos ? slab_.front(kClock) : next;
+}
+
+template<typename Key, typename Value, typename Index>
+uint32_t ClockProCache<Key, Value, Index>::retreat(uint32_t node) const
+{
+    uint32_t prev = slab_.prev(node);
+    return prev == NodeSlab::npos ? slab_.back(kClock) : prev;
+}
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::addNode(const Key& key, const Value& value, Type type)
+{
+    evict();
+    uint32_t node = slab_.allocate(key, value);
+    types_[node] = type;
+    refBits_[node].store(0, std::memory_order_relaxed);
+    if(handHot_ == NodeSlab::npos){
+        slab_.pushBack(kClock, node);
+        handHot_ = handCold_ = handTest_ = node;
+    }else{
+        // 热指针所在的条目最旧，插在它前面即成为最新的条目，热指针转一圈才会再回到这里
+        slab_.insertBefore(handHot_, node);
+    }
+    if(type == kHot) ++hotCount_;
+    else ++coldCount_;
+    nodeMap_.insert(key, node);
+}
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::deleteNode(uint32_t node)
+{
+    // 指针后退一步，随后的advance会落到被删节点原来的后继上
+    uint32_t prev = retreat(node);
+    if(prev == node) prev = NodeSlab::npos;   // 删除的是环中最后一个节点
+    if(handHot_ == node) handHot_ = prev;
+    if(handCold_ == node) handCold_ = prev;
+    if(handTest_ == node) handTest_ = prev;
+    slab_.unlink(node);
+    nodeMap_.erase(slab_[node].getKey());
+    slab_.release(node);
+}
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::evict()
+{
+    // 三根指针各自只前进一步，不互相推动，避免冷、热、测试指针重合时相互递归
+    while(hotCount_ + coldCount_ >= capacity_){
+        runHandCold();
+        while(testCount_ > capacity_){
+            runHandTest();
+        }
+        while(hotCount_ > capacity_ - coldTarget_){
+            runHandHot();
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::runHandCold()
+{
+    uint32_t node = handCold_;
+    if(types_[node] == kCold){
+        if(testAndClearRef(node)){
+            // 冷条目在被淘汰前再次被访问，升为热条目
+            types_[node] = kHot;
+            --coldCount_;
+            ++hotCount_;
+        }else{
+            // 淘汰value，只保留key作为测试条目
+            types_[node] = kTest;
+            slab_[node].setValue(Value());
+            --coldCount_;
+            ++testCount_;
+        }
+    }
+    handCold_ = advance(handCold_);
+}
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::runHandHot()
+{
+    uint32_t node = handHot_;
+    if(types_[node] == kHot){
+        if(!testAndClearRef(node)){
+            types_[node] = kCold;
+            --hotCount_;
+            ++coldCount_;
+        }
+    }
+    handHot_ = advance(handHot_);
+}
+
+template<typename Key, typename Value, typename Index>
+void ClockProCache<Key, Value, Index>::runHandTest()
+{
+    uint32_t node = handTest_;
+    if(types_[node] == kTest){
+        // 测试期内没有再被访问，说明冷条目给得太多
+        --testCount_;
+        deleteNode(node);
+        if(coldTarget_ > 1) --coldTarget_;
+    }
+    handTest_ = advance(handTest_);
+}
+
+template<typename Key, typename Value, typename Index>
+bool ClockProCache<Key, Value, Index>::testAndClearRef(uint32_t node)
+{
+    if(refBits_[node].load(std::memory_order_relaxed) == 0) return false;
+    refBits_[node].store(0, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CacheHash.h"
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "ShardArray.h"
+#include "SharedSpinLock.h"
+
+// 不分片的并发缓存：整个缓存只有一个容量和一个全局的CLOCK淘汰顺序（近似LRU），并发只来自分段加锁的key索引
+// 分片缓存在容量很小时每个分片只有几个条目，热分片淘汰的同时冷分片还有空位；这里所有槽位共享，不存在这个问题
+//   索引：key按哈希高位分到若干段，每段一个哈希表和一把读写自旋锁，段之间按缓存行隔开
+//   槽位：key、value、哈希和引用位存放在全局数组中，槽位的内容由其key所在段的锁保护
+//   淘汰：全局的时钟指针和空闲槽位由slotMutex_保护，只在需要新槽位时获取
+// get只加一个段的共享锁，命中只置引用位；put加段的独占锁，需要新槽位时先释放段锁，
+// 取得槽位后再重新加锁插入，任何时刻不会同时持有两个段的锁；加锁顺序固定为slotMutex_在前、段锁在后
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
+class ConcurrentLruCache : public cachePolicy<Key, Value>
+{
+public:
+    using Nodemap = typename Index::template Map<Key, uint32_t, Hash>;  // key到槽位下标的映射
+
+    // stripeNum为索引的段数，向上取整为2的幂；不大于0时取硬件线程数的4倍
+    ConcurrentLruCache(size_t capacity, int stripeNum = 0)
+    : capacity_(capacity)
+    , stripeMask_(roundUpPow2(stripeNum > 0 ? stripeNum : std::thread::hardware_concurrency() * 4) - 1)
+    , hand_(0)
+    , keys_(capacity)
+    , values_(capacity)
+    , hashes_(capacity, 0)
+    , refBits_(capacity)
+    , occupied_(capacity)
+    , stripes_(stripeMask_ + 1)
+    {
+        for(size_t i = 0; i < capacity_; i++){
+            refBits_[i].store(0, std::memory_order_relaxed);
+            occupied_[i].store(0, std::memory_order_relaxed);
+        }
+        freeSlots_.reserve(capacity_);
+        for(size_t i = capacity_; i > 0; i--){
+            freeSlots_.push_back(static_cast<uint32_t>(i - 1));
+        }
+        size_t stripeSize = capacity_ / (stripeMask_ + 1) + 1;
+        for(size_t i = 0; i <= stripeMask_; i++){
+            stripes_.emplace_back(stripeSize);
+        }
+    }
+
+    ~ConcurrentLruCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+    void remove(Key key);
+
+private:
+    struct Stripe{
+        explicit Stripe(size_t expected) : nodeMap(expected) {}
+        SharedSpinLock lock;
+        Nodemap nodeMap;
+    };
+
+    static const int kSweepRounds = 2;   // 一次扫描最多转的圈数，找不到时释放slotMutex_后重试
+
+    Stripe& stripeOf(size_t hash) { return stripes_[shardOf(hash, stripeMask_)]; }
+    uint32_t acquireSlot();              // 取得一个不在任何段中的槽位：优先空闲槽位，否则按CLOCK淘汰
+    bool trySweep(uint32_t& slot);       // 转动时钟指针淘汰一个条目，需持有slotMutex_
+    void releaseSlot(uint32_t slot);     // 归还未使用的槽位
+
+private:
+    size_t capacity_;
+    size_t stripeMask_;                  // 段数减一
+    size_t hand_;                        // 时钟指针，由slotMutex_保护
+    std::vector<Key> keys_;
+    std::vector<Value> values_;
+    std::vector<size_t> hashes_;
+    std::vector<std::atomic<uint8_t>> refBits_;   // 引用位，命中时在共享锁下置位
+    std::vector<std::atomic<uint8_t>> occupied_;  // 槽位是否已插入段中，时钟只淘汰已插入的槽位
+    std::vector<uint32_t> freeSlots_;    // 空闲槽位，由slotMutex_保护
+    std::mutex slotMutex_;
+    ShardArray<Stripe> stripes_;
+};
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void ConcurrentLruCache<Key, Value, Index, Hash>::put(Key key, Value value)
+{
+    if(capacity_ == 0) return;
+    size_t hash = cacheHashOf(Hash(), key);
+    Stripe& stripe = stripeOf(hash);
+    {
+        std::lock_guard<SharedSpinLock> lock(stripe.lock);
+        uint32_t* found = stripe.nodeMap.find(key, hash);
+        if(found != nullptr){
+            values_[*found] = value;
+            refBits_[*found].store(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // 槽位不在任何段中，填写时不需要加锁
+    uint32_t slot = acquireSlot();
+    keys_[slot] = key;
+    values_[slot] = value;
+    hashes_[slot] = hash;
+    refBits_[slot].store(0, std::memory_order_relaxed);
+
+    bool inserted = false;
+    {
+        std::lock_guard<SharedSpinLock> lock(stripe.lock);
+        uint32_t* found = stripe.nodeMap.find(key, hash);
+        if(found != nullptr){
+            // 释放段锁期间其他线程插入了同一个key
+            values_[*found] = value;
+            refBits_[*found].store(1, std::memory_order_relaxed);
+        }else{
+            stripe.nodeMap.insert(key, slot, hash);
+            occupied_[slot].store(1, std::memory_order_release);
+            inserted = true;
+        }
+    }
+    if(!inserted){
+        values_[slot] = Value();
+        releaseSlot(slot);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ConcurrentLruCache<Key, Value, Index, Hash>::get(Key key, Value& value)
+{
+    size_t hash = cacheHashOf(Hash(), key);
+    Stripe& stripe = stripeOf(hash);
+    SharedLockGuard<SharedSpinLock> lock(stripe.lock);
+    const Nodemap& nodeMap = stripe.nodeMap;
+    const uint32_t* found = nodeMap.find(key, hash);
+    if(found == nullptr) return false;
+    // 已经置位时不再写，避免热点条目所在的缓存行在核间来回失效
+    if(refBits_[*found].load(std::memory_order_relaxed) == 0){
+        refBits_[*found].store(1, std::memory_order_relaxed);
+    }
+    value = values_[*found];
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+Value ConcurrentLruCache<Key, Value, Index, Hash>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void ConcurrentLruCache<Key, Value, Index, Hash>::remove(Key key)
+{
+    size_t hash = cacheHashOf(Hash(), key);
+    Stripe& stripe = stripeOf(hash);
+    uint32_t slot;
+    {
+        std::lock_guard<SharedSpinLock> lock(stripe.lock);
+        uint32_t* found = stripe.nodeMap.find(key, hash);
+        if(found == nullptr) return;
+        slot = *found;
+        stripe.nodeMap.erase(key, hash);
+        occupied_[slot].store(0, std::memory_order_relaxed);
+        values_[slot] = Value();
+    }
+    // 不能在持有段锁时获取slotMutex_
+    releaseSlot(slot);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+uint32_t ConcurrentLruCache<Key, Value, Index, Hash>::acquireSlot()
+{
+    for(;;){
+        {
+            std::lock_guard<std::mutex> lock(slotMutex_);
+            if(!freeSlots_.empty()){
+                uint32_t slot = freeSlots_.back();
+                freeSlots_.pop_back();
+                return slot;
+            }
+            uint32_t slot;
+            if(trySweep(slot)) return slot;
+        }
+        // 所有槽位都被其他线程取走、尚未插入，等它们插入或归还
+        std::this_thread::yield();
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool ConcurrentLruCache<Key, Value, Index, Hash>::trySweep(uint32_t& slot)
+{
+    for(size_t step = 0; step < capacity_ * kSweepRounds; step++){
+        uint32_t victim = static_cast<uint32_t>(hand_);
+        hand_ = (hand_ + 1) % capacity_;
+        if(occupied_[victim].load(std::memory_order_acquire) == 0) continue;
+        if(refBits_[victim].load(std::memory_order_relaxed) != 0){
+            refBits_[victim].store(0, std::memory_order_relaxed);
+            continue;
+        }
+        // 在victim的段锁下确认槽位仍属于该key后再删除，期间它可能已被remove
+        Stripe& stripe = stripeOf(hashes_[victim]);
+        std::lock_guard<SharedSpinLock> lock(stripe.lock);
+        if(occupied_[victim].load(std::memory_order_relaxed) == 0) continue;
+        stripe.nodeMap.erase(keys_[victim], hashes_[victim]);
+        occupied_[victim].store(0, std::memory_order_relaxed);
+        slot = victim;
+        return true;
+    }
+    return false;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void ConcurrentLruCache<Key, Value, Index, Hash>::releaseSlot(uint32_t slot)
+{
+    std::lock_guard<std::mutex> lock(slotMutex_);
+    freeSlots_.push_back(slot);
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "CacheHash.h"
+
+// 开放寻址哈希表，作为各缓存策略的key索引
+// 所有槽位存放在一段连续数组中，线性探测查找，一次查找通常只访问一条缓存行
+// 删除时采用后移删除（backward shift），不使用墓碑，也不会触发内存分配
+// 容量按缓存容量预先分配，装载因子超过1/2时才扩容
+// 槽位不单设占用标志：保存的哈希值最高位置1，为0即空槽，int键值的槽位从24字节缩小到16字节，一条缓存行放4个
+template<typename Key, typename T, typename Hash = std::hash<Key>>
+class FlatHashMap{
+private:
+    struct Slot{
+        Key key;
+        T value;
+        size_t hash;   // 混合后的哈希值（最高位置1），扩容和删除时无需重新计算；0表示空槽
+
+        Slot():key(), value(), hash(0) {}
+        bool used() const { return hash != 0; }
+    };
+
+    static const size_t kUsedBit = ~(~static_cast<size_t>(0) >> 1);
+    static size_t tagOf(size_t hash) { return hash | kUsedBit; }   // 槽位中保存的哈希值，低位决定的起始槽位不变
+
+public:
+    explicit FlatHashMap(size_t expected = 0)
+    : size_(0)
+    , mask_(0)
+    {
+        reserve(expected);
+    }
+
+    T* find(const Key& key);                          // 查找key，不存在时返回nullptr
+    const T* find(const Key& key) const;
+    bool contains(const Key& key) const { return find(key) != nullptr; }
+    T& operator[](const Key& key);                    // 不存在时插入默认值
+    bool insert(const Key& key, const T& value);      // 插入或覆盖，返回是否为新插入
+    bool erase(const Key& key);                       // 删除key，返回是否删除成功
+
+    // 表内使用的哈希值；以下重载直接使用调用方已算好的hashOf(key)，不再重复计算
+    size_t hashOf(const Key& key) const { return cacheHashOf(hasher_, key); }
+    T* find(const Key& key, size_t hash);
+    const T* find(const Key& key, size_t hash) const;
+    bool insert(const Key& key, const T& value, size_t hash);
+    bool erase(const Key& key, size_t hash);
+    void clear();
+    void reserve(size_t expected);                    // 保证容纳expected个元素时不扩容
+
+    template<typename Func>
+    void forEach(Func func);                          // 遍历所有元素，func(const Key&, T&)
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    size_t findSlot(const Key& key, size_t hash) const;  // 返回key所在槽位，不存在时返回slots_.size()
+    size_t insertSlot(const Key& key, size_t hash);   // 返回key所在或新插入的槽位
+    void eraseSlot(size_t index);                     // 后移删除
+    void rehash(size_t slotNum);
+
+private:
+    std::vector<Slot> slots_;
+    size_t size_;
+    size_t mask_;
+    Hash hasher_;
+};
+
+template<typename Key, typename T, typename Hash>
+const size_t FlatHashMap<Key, T, Hash>::kUsedBit;
+
+template<typename Key, typename T, typename Hash>
+T* FlatHashMap<Key, T, Hash>::find(const Key& key){
+    return find(key, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+T* FlatHashMap<Key, T, Hash>::find(const Key& key, size_t hash){
+    size_t index = findSlot(key, hash);
+    return index == slots_.size() ? nullptr : &slots_[index].value;
+}
+
+template<typename Key, typename T, typename Hash>
+const T* FlatHashMap<Key, T, Hash>::find(const Key& key) const{
+    return find(key, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+const T* FlatHashMap<Key, T, Hash>::find(const Key& key, size_t hash) const{
+    size_t index = findSlot(key, hash);
+    return index == slots_.size() ? nullptr : &slots_[index].value;
+}
+
+template<typename Key, typename T, typename Hash>
+T& FlatHashMap<Key, T, Hash>::operator[](const Key& key){
+    return slots_[insertSlot(key, hashOf(key))].value;
+}
+
+template<typename Key, typename T, typename Hash>
+bool FlatHashMap<Key, T, Hash>::insert(const Key& key, const T& value){
+    return insert(key, value, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+bool FlatHashMap<Key, T, Hash>::insert(const Key& key, const T& value, size_t hash){
+    size_t oldSize = size_;
+    slots_[insertSlot(key, hash)].value = value;
+    return size_ != oldSize;
+}
+
+template<typename Key, typename T, typename Hash>
+bool FlatHashMap<Key, T, Hash>::erase(const Key& key){
+    return erase(key, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+bool FlatHashMap<Key, T, Hash>::erase(const Key& key, size_t hash){
+    size_t index = findSlot(key, hash);
+    if(index == slots_.size()) return false;
+    eraseSlot(index);
+    return true;
+}
+
+template<typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::clear(){
+    for(auto& slot : slots_){
+        slot = Slot();
+    }
+    size_ = 0;
+}
+
+template<typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::reserve(size_t expected){
+    size_t slotNum = 8;
+    while(slotNum < expected * 2) slotNum <<= 1;
+    if(slotNum > slots_.size()){
+        rehash(slotNum);
+    }
+}
+
+template<typename Key, typename T, typename Hash>
+template<typename Func>
+void FlatHashMap<Key, T, Hash>::forEach(Func func){
+    for(auto& slot : slots_){
+        if(slot.used()) func(slot.key, slot.value);
+    }
+}
+
+template<typename Key, typename T, typename Hash>
+size_t FlatHashMap<Key, T, Hash>::findSlot(const Key& key, size_t hash) const{
+    size_t tag = tagOf(hash);
+    size_t index = hash & mask_;
+    while(slots_[index].used()){
+        if(slots_[index].hash == tag && slots_[index].key == key){
+            return index;
+        }
+        index = (index + 1) & mask_;
+    }
+    return slots_.size();
+}
+
+template<typename Key, typename T, typename Hash>
+size_t FlatHashMap<Key, T, Hash>::insertSlot(const Key& key, size_t hash){
+    size_t index = findSlot(key, hash);
+    if(index != slots_.size()) return index;
+
+    // 装载因子不超过1/2，保证探测序列足够短
+    if((size_ + 1) * 2 > slots_.size()){
+        rehash(slots_.size() * 2);
+    }
+    index = hash & mask_;
+    while(slots_[index].used()){
+        index = (index + 1) & mask_;
+    }
+    slots_[index].key = key;
+    slots_[index].hash = tagOf(hash);
+    ++size_;
+    return index;
+}
+
+template<typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::eraseSlot(size_t index){
+    // 将后续探测链上的元素前移填补空位，直到遇到空槽或已在理想位置的元素
+    size_t hole = index;
+    size_t next = (hole + 1) & mask_;
+    while(slots_[next].used()){
+        size_t home = slots_[next].hash & mask_;
+        // home不在(hole, next]区间内时，元素可以移动到hole
+        if(((next - home) & mask_) >= ((next - hole) & mask_)){
+            slots_[hole] = std::move(slots_[next]);
+            hole = next;
+        }
+        next = (next + 1) & mask_;
+    }
+    slots_[hole] = Slot();
+    --size_;
+}
+
+template<typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::rehash(size_t slotNum){
+    std::vector<Slot> oldSlots(slotNum);
+    oldSlots.swap(slots_);
+    mask_ = slotNum - 1;
+    for(auto& slot : oldSlots){
+        if(!slot.used()) continue;
+        size_t index = slot.hash & mask_;
+        while(slots_[index].used()){
+            index = (index + 1) & mask_;
+        }
+        slots_[index] = std::move(slot);
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 4位计数的Count-Min Sketch，估计key最近的访问频次，供TinyLFU做准入判断
+// 每个uint64_t装16个4位计数器，每个key在4个不同的字中各对应一个计数器，估计值取4个计数器的最小值
+// 累计增加sampleSize次后所有计数器减半，使旧的访问记录逐渐失效
+// 传入的hash为已充分混合的64位哈希（cacheHashOf），由缓存与key索引共用
+class FrequencySketch
+{
+public:
+    explicit FrequencySketch(size_t capacity)
+    : table_(tableSize(capacity), 0)
+    , tableMask_(table_.size() - 1)
+    , sampleSize_(capacity == 0 ? 10 : capacity * 10)
+    , additions_(0)
+    {}
+
+    void increment(uint64_t hash);           // 记录一次访问
+    uint32_t frequency(uint64_t hash) const; // 估计访问频次，范围[0, 15]
+
+private:
+    static size_t tableSize(size_t capacity); // 字数，取不小于capacity的2的幂，最少8个
+    static uint64_t indexHash(uint64_t hash, int depth);
+    void reset();                             // 所有计数器减半
+
+private:
+    static const uint64_t kResetMask = 0x7777777777777777ULL; // 右移一位后清掉每个计数器从高位移入的比特
+
+    std::vector<uint64_t> table_;
+    size_t tableMask_;
+    size_t sampleSize_;   // 每累计这么多次增加就减半一次
+    size_t additions_;    // 自上次减半以来的增加次数
+};
+
+inline size_t FrequencySketch::tableSize(size_t capacity)
+{
+    size_t size = 8;
+    while(size < capacity) size <<= 1;
+    return size;
+}
+
+inline uint64_t FrequencySketch::indexHash(uint64_t hash, int depth)
+{
+    // 每一层用不同的奇数种子重新混合，得到相互独立的位置
+    static const uint64_t kSeeds[4] = {
+        0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+        0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+    };
+    uint64_t h = (hash + kSeeds[depth]) * kSeeds[depth];
+    return h ^ (h >> 32);
+}
+
+inline void FrequencySketch::increment(uint64_t hash)
+{
+    bool added = false;
+    for(int depth = 0; depth < 4; depth++){
+        uint64_t h = indexHash(hash, depth);
+        size_t index = h & tableMask_;
+        int offset = static_cast<int>((h >> 60) & 15) << 2;
+        uint64_t mask = 0xfULL << offset;
+        if((table_[index] & mask) != mask){
+            table_[index] += 1ULL << offset;
+            added = true;
+        }
+    }
+    if(added && ++additions_ >= sampleSize_){
+        reset();
+    }
+}
+
+inline uint32_t FrequencySketch::frequency(uint64_t hash) const
+{
+    uint32_t freq = 15;
+    for(int depth = 0; depth < 4; depth++){
+        uint64_t h = indexHash(hash, depth);
+        size_t index = h & tableMask_;
+        int offset = static_cast<int>((h >> 60) & 15) << 2;
+        uint32_t count = static_cast<uint32_t>((table_[index] >> offset) & 0xf);
+        if(count < freq) freq = count;
+    }
+    return freq;
+}
+
+inline void FrequencySketch::reset()
+{
+    for(auto& word : table_){
+        word = (word >> 1) & kResetMask;
+    }
+    additions_ /= 2;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <cmath>
+
+#include "CachePolicy.h"
+#include "ShardArray.h"
+#include "ClockCache.h"
+
+// 分片数向上取整为2的幂，key的哈希高位按掩码选分片，完整的哈希值传给分片；Hash为可替换的哈希函数，默认CacheHash
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
+class HashClockCache: public cachePolicy<Key, Value>
+{
+public:
+    HashClockCache(size_t capacity, int sliceNum)
+    :capacity_(capacity)
+    ,sliceNum_(static_cast<int>(roundUpPow2(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())))
+    ,sliceMask_(sliceNum_ - 1)
+    ,clockSliceCaches_(sliceNum_)
+    {
+        size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
+        for(int i=0;i<sliceNum_; i++){
+            clockSliceCaches_.emplace_back(sliceSize);
+        }
+    }
+
+public:
+    void put(Key key, Value value);
+    bool get(Key key, Value& value);
+    Value get(Key key);
+
+    int sliceNum() const { return sliceNum_; }
+    size_t sliceIndex(const Key& key) const { return shardOf(cacheHashOf(Hash(), key), sliceMask_); } // key所在的分片，供统计分片负载
+
+private:
+    size_t HashValue(Key key);
+
+private:
+    size_t capacity_;
+    int sliceNum_;
+    size_t sliceMask_;   // 分片数减一
+    ShardArray<ClockCache<Key, Value, Index, Hash>> clockSliceCaches_;  // 切片CLOCK缓存
+};
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void HashClockCache<Key, Value, Index, Hash>::put(Key key, Value value){
+    // key的哈希只算一次：高位选slice，完整的哈希值传给slice使用
+    size_t hash = HashValue(key);
+    clockSliceCaches_[shardOf(hash, sliceMask_)].put(key, value, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool HashClockCache<Key, Value, Index, Hash>::get(Key key, Value& value){
+    size_t hash = HashValue(key);
+    return clockSliceCaches_[shardOf(hash, sliceMask_)].get(key, value, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+Value HashClockCache<Key, Value, Index, Hash>::get(Key key){
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+size_t HashClockCache<Key, Value, Index, Hash>::HashValue(Key key){
+    return cacheHashOf(Hash(), key);
+}
\ No newline at end of file
@@ -1,27 +1,34 @@
 #pragma once
 
-#include <memory>
 #include <thread>
 #include <mutex>
 #include <vector>
 #include <cmath>
+#include <memory>
 
 #include "CachePolicy.h"
+#include "ShardArray.h"
+#include "SliceRebalancer.h"
 #include "LfuCache.h"
 
-template<typename Key, typename Value>
+// 分片数向上取整为2的幂，key的哈希高位按掩码选分片；Hash为可替换的哈希函数，默认CacheHash；Lock为各分片的锁策略，默认std::mutex
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>, typename Lock = std::mutex>
 class HashLfuCache: public cachePolicy<Key, Value>
 {
 public:
     // "std::thread::hardware_concurrency(),表示硬件并发线程数（通常为CPU核心数）"
-    HashLfuCache(size_t capacity, int sliceNum)
+    // rebalance为true时按各分片的未命中数在分片之间调配容量，见SliceRebalancer
+    HashLfuCache(size_t capacity, int sliceNum, bool rebalance = false)
     :capacity_(capacity)
-    ,sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
+    ,sliceNum_(static_cast<int>(roundUpPow2(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())))
+    ,sliceMask_(sliceNum_ - 1)
+    ,LfuSliceCaches_(sliceNum_)
     {
         size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
         for(int i=0;i<sliceNum_; i++){
-            LfuSliceCaches_.emplace_back(new LfuCache<Key, Value>(sliceSize));
+            LfuSliceCaches_.emplace_back(sliceSize);
         }
+        if(rebalance) rebalancer_.reset(new SliceRebalancer(sliceNum_, sliceSize));
     }
 
 public:
@@ -29,37 +36,52 @@ public:
     bool get(Key key, Value& value);
     Value get(Key key);
 
+    int sliceNum() const { return sliceNum_; }
+    size_t sliceIndex(const Key& key) const { return shardOf(cacheHashOf(Hash(), key), sliceMask_); } // key所在的分片，供统计分片负载
+
 private:
     size_t HashValue(Key key);
+    void rebalanceSlices();
 
 private:
     size_t capacity_;
     int sliceNum_;
-    std::vector<std::unique_ptr<LfuCache<Key, Value>>> LfuSliceCaches_;  // 切片Lfu缓存
+    size_t sliceMask_;   // 分片数减一
+    ShardArray<LfuCache<Key, Value, Index, Hash, Lock>> LfuSliceCaches_;  // 切片Lfu缓存
+    std::unique_ptr<SliceRebalancer> rebalancer_;  // 未开启再平衡时为空
 };
 
-template<typename Key, typename Value>
-void HashLfuCache<Key, Value>::put(Key key, Value value){
-    // 计算key对应的hash值，即slice索引
-    size_t sliceIndex = HashValue(key) % sliceNum_;
-    LfuSliceCaches_[sliceIndex]->put(key, value);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void HashLfuCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value){
+    // key的哈希只算一次：高位选slice，完整的哈希值传给slice使用
+    size_t hash = HashValue(key);
+    LfuSliceCaches_[shardOf(hash, sliceMask_)].put(key, value, hash);
 }
 
-template<typename Key, typename Value>
-bool HashLfuCache<Key ,Value>::get(Key key, Value& value){
-    size_t sliceIndex = HashValue(key)% sliceNum_;
-    return LfuSliceCaches_[sliceIndex]->get(key, value);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool HashLfuCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value){
+    size_t hash = HashValue(key);
+    size_t slice = shardOf(hash, sliceMask_);
+    bool hit = LfuSliceCaches_[slice].get(key, value, hash);
+    if(rebalancer_ && rebalancer_->record(slice, hit)) rebalanceSlices();
+    return hit;
 }
 
-template<typename Key, typename Value>
-Value HashLfuCache<Key, Value>::get(Key key){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+Value HashLfuCache<Key, Value, Index, Hash, Lock>::get(Key key){
     Value value{};
     get(key, value);
     return value;
 }
 
-template<typename Key, typename Value>
-size_t HashLfuCache<Key, Value>::HashValue(Key key){
-    std::hash<Key> hashFunc;
-    return hashFunc(key);
-}
\ No newline at end of file
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+size_t HashLfuCache<Key, Value, Index, Hash, Lock>::HashValue(Key key){
+    return cacheHashOf(Hash(), key);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void HashLfuCache<Key, Value, Index, Hash, Lock>::rebalanceSlices(){
+    rebalancer_->rebalance(
+        [this](size_t i){ return LfuSliceCaches_[i].size(); },
+        [this](size_t i, size_t capacity){ LfuSliceCaches_[i].setCapacity(static_cast<int>(capacity)); });
+}
@@ -1,27 +1,31 @@
 #pragma once
 
-#include <memory>
 #include <thread>
 #include <mutex>
 #include <vector>
 #include <cmath>
+#include <memory>
 
 #include "CachePolicy.h"
+#include "ShardArray.h"
+#include "SliceRebalancer.h"
+#include "SliceTable.h"
 #include "LruCache.h"
 
-template<typename Key, typename Value>
+// 分片数向上取整为2的幂，key的哈希高位按掩码选分片；Hash为可替换的哈希函数，默认CacheHash；Lock为各分片的锁策略，默认std::mutex
+// 分片保存在SliceTable中，运行时可以用resize改变总容量、用reshard改变分片数，缓存中的数据不会丢失
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>, typename Lock = std::mutex>
 class HashLruCache: public cachePolicy<Key, Value>
 {
 public:
     // "std::thread::hardware_concurrency(),表示硬件并发线程数（通常为CPU核心数）"
-    HashLruCache(size_t capacity, int sliceNum)
-    :capacity_(capacity)
-    ,sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
+    // promotionRatio见LruCache，按分片容量计算；rebalance为true时按各分片的未命中数在分片之间调配容量，见SliceRebalancer
+    HashLruCache(size_t capacity, int sliceNum, double promotionRatio = 0, bool rebalance = false)
+    :promotionRatio_(promotionRatio)
+    ,lruSliceCaches_(capacity, sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency(),
+                     [this](ShardArray<SliceType>& chunk, size_t count, size_t sliceSize){ makeSlices(chunk, count, sliceSize); })
     {
-        size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
-        for(int i=0;i<sliceNum_; i++){
-            lruSliceCaches_.emplace_back(new LruCache<Key, Value>(sliceSize));
-        }
+        if(rebalance) rebalancer_.reset(new SliceRebalancer(lruSliceCaches_.sliceNum(), lruSliceCaches_.sliceCapacity()));
     }
 
 public:
@@ -29,37 +33,82 @@ public:
     bool get(Key key, Value& value);
     Value get(Key key);
 
+    // 改变总容量，减小时超出的条目由各分片在之后的插入中逐步淘汰；开启再平衡时各分片的容量重新平均分配
+    void resize(size_t capacity);
+    // 改变分片数（向上取整为2的幂），条目在之后的访问中逐步迁移，见SliceTable；上一次迁移未完成或开启了再平衡时返回false
+    bool reshard(int sliceNum);
+
+    int sliceNum() const { return static_cast<int>(lruSliceCaches_.sliceNum()); }
+    size_t sliceIndex(const Key& key) const { return lruSliceCaches_.indexOf(cacheHashOf(Hash(), key)); } // key所在的分片，供统计分片负载
+
 private:
+    using SliceType = LruCache<Key, Value, Index, Hash, Lock>;
+
     size_t HashValue(Key key);
+    void makeSlices(ShardArray<SliceType>& chunk, size_t count, size_t sliceSize);
+    void rebalanceSlices();
 
 private:
-    size_t capacity_;
-    int sliceNum_;
-    std::vector<std::unique_ptr<LruCache<Key, Value>>> lruSliceCaches_;  // 切片LRU缓存
+    double promotionRatio_;
+    SliceTable<Key, Value, SliceType> lruSliceCaches_;  // 切片LRU缓存
+    std::unique_ptr<SliceRebalancer> rebalancer_;  // 未开启再平衡时为空
 };
 
-template<typename Key, typename Value>
-void HashLruCache<Key, Value>::put(Key key, Value value){
-    // 计算key对应的hash值，即slice索引
-    size_t sliceIndex = HashValue(key) % sliceNum_;
-    lruSliceCaches_[sliceIndex]->put(key, value);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void HashLruCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value){
+    // key的哈希只算一次：高位选slice，完整的哈希值传给slice使用
+    size_t hash = HashValue(key);
+    lruSliceCaches_.put(key, value, hash);
 }
 
-template<typename Key, typename Value>
-bool HashLruCache<Key ,Value>::get(Key key, Value& value){
-    size_t sliceIndex = HashValue(key)% sliceNum_;
-    return lruSliceCaches_[sliceIndex]->get(key, value);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool HashLruCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value){
+    size_t hash = HashValue(key);
+    bool hit = lruSliceCaches_.get(key, value, hash);
+    // 开启再平衡时不会reshard，分片下标不变
+    if(rebalancer_ && rebalancer_->record(lruSliceCaches_.indexOf(hash), hit)) rebalanceSlices();
+    return hit;
 }
 
-template<typename Key, typename Value>
-Value HashLruCache<Key, Value>::get(Key key){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+Value HashLruCache<Key, Value, Index, Hash, Lock>::get(Key key){
     Value value{};
     get(key, value);
     return value;
 }
 
-template<typename Key, typename Value>
-size_t HashLruCache<Key, Value>::HashValue(Key key){
-    std::hash<Key> hashFunc;
-    return hashFunc(key);
-}
\ No newline at end of file
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+size_t HashLruCache<Key, Value, Index, Hash, Lock>::HashValue(Key key){
+    return cacheHashOf(Hash(), key);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void HashLruCache<Key, Value, Index, Hash, Lock>::resize(size_t capacity){
+    lruSliceCaches_.resize(capacity);
+    if(rebalancer_){
+        rebalancer_->reset(lruSliceCaches_.sliceCapacity(),
+            [this](size_t i, size_t sliceSize){ lruSliceCaches_[i].setCapacity(static_cast<int>(sliceSize)); });
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool HashLruCache<Key, Value, Index, Hash, Lock>::reshard(int sliceNum){
+    // 再平衡的计数和容量预算按构造时的分片数分配
+    if(rebalancer_) return false;
+    return lruSliceCaches_.reshard(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency(),
+        [this](ShardArray<SliceType>& chunk, size_t count, size_t sliceSize){ makeSlices(chunk, count, sliceSize); });
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void HashLruCache<Key, Value, Index, Hash, Lock>::makeSlices(ShardArray<SliceType>& chunk, size_t count, size_t sliceSize){
+    for(size_t i = 0; i < count; i++){
+        chunk.emplace_back(static_cast<int>(sliceSize), promotionRatio_);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void HashLruCache<Key, Value, Index, Hash, Lock>::rebalanceSlices(){
+    rebalancer_->rebalance(
+        [this](size_t i){ return lruSliceCaches_[i].size(); },
+        [this](size_t i, size_t capacity){ lruSliceCaches_[i].setCapacity(static_cast<int>(capacity)); });
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <cmath>
+
+#include "CachePolicy.h"
+#include "ShardArray.h"
+#include "LruKCache.h"
+
+// 分片数向上取整为2的幂，key的哈希高位按掩码选分片，完整的哈希值传给分片；Hash为可替换的哈希函数，默认CacheHash
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
+class HashLruKCache: public cachePolicy<Key, Value>
+{
+public:
+    // historyCapacity与capacity一样按切片数平分
+    HashLruKCache(size_t capacity, int sliceNum, size_t historyCapacity, int k)
+    :capacity_(capacity)
+    ,sliceNum_(static_cast<int>(roundUpPow2(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())))
+    ,sliceMask_(sliceNum_ - 1)
+    ,lruKSliceCaches_(sliceNum_)
+    {
+        size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
+        size_t sliceHistory = std::ceil(historyCapacity / static_cast<double>(sliceNum_));
+        for(int i=0;i<sliceNum_; i++){
+            lruKSliceCaches_.emplace_back(sliceSize, sliceHistory, k);
+        }
+    }
+
+public:
+    void put(Key key, Value value);
+    bool get(Key key, Value& value);
+    Value get(Key key);
+
+    int sliceNum() const { return sliceNum_; }
+    size_t sliceIndex(const Key& key) const { return shardOf(cacheHashOf(Hash(), key), sliceMask_); } // key所在的分片，供统计分片负载
+
+private:
+    size_t HashValue(Key key);
+
+private:
+    size_t capacity_;
+    int sliceNum_;
+    size_t sliceMask_;   // 分片数减一
+    ShardArray<LruKCache<Key, Value, Index, Hash>> lruKSliceCaches_;  // 切片LRU-K缓存
+};
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void HashLruKCache<Key, Value, Index, Hash>::put(Key key, Value value){
+    // key的哈希只算一次：高位选slice，完整的哈希值传给slice使用
+    size_t hash = HashValue(key);
+    lruKSliceCaches_[shardOf(hash, sliceMask_)].put(key, value, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool HashLruKCache<Key, Value, Index, Hash>::get(Key key, Value& value){
+    size_t hash = HashValue(key);
+    return lruKSliceCaches_[shardOf(hash, sliceMask_)].get(key, value, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+Value HashLruKCache<Key, Value, Index, Hash>::get(Key key){
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+size_t HashLruKCache<Key, Value, Index, Hash>::HashValue(Key key){
+    return cacheHashOf(Hash(), key);
+}
\ No newline at end of file
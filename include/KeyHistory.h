@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LRU-K的访问历史：定长的组相联表，只记录key的32位指纹和访问次数，不保存key和value
+// 每组4个槽位，key的哈希（cacheHashOf，由缓存与key索引共用）低位选组、高32位作指纹；组满时用组内的小时钟淘汰一个最近未被访问的槽位
+// 表在构造时一次性分配，之后记录、删除都不会分配内存，内存固定为historyCapacity * 8字节左右
+// 不同key的指纹可能相同，此时二者共享一个计数，只会让某个key提前达到k次，不影响正确性
+class KeyHistory
+{
+public:
+    explicit KeyHistory(size_t capacity)
+    : setMask_(setCount(capacity) - 1)
+    , slots_((setMask_ + 1) * kWays)
+    , hands_(setMask_ + 1, 0)
+    {}
+
+    uint32_t record(uint64_t hash);          // 记录一次访问，返回包括本次在内的访问次数
+    void erase(uint64_t hash);               // 删除记录
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    struct Slot{
+        uint32_t tag = 0;     // 指纹，0表示空槽位
+        uint8_t count = 0;    // 访问次数，饱和于255
+        uint8_t ref = 0;      // 时钟引用位
+    };
+
+    static const size_t kWays = 4;
+
+    static size_t setCount(size_t capacity); // 组数，取不小于capacity / kWays的2的幂
+    static uint32_t tagOf(uint64_t hash);
+    Slot* setOf(uint64_t hash) { return &slots_[(hash & setMask_) * kWays]; }
+
+private:
+    size_t setMask_;
+    std::vector<Slot> slots_;
+    std::vector<uint8_t> hands_;  // 每组的时钟指针
+};
+
+inline size_t KeyHistory::setCount(size_t capacity)
+{
+    size_t count = 1;
+    while(count * kWays < capacity) count <<= 1;
+    return count;
+}
+
+inline uint32_t KeyHistory::tagOf(uint64_t hash)
+{
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    return tag == 0 ? 1 : tag;
+}
+
+inline uint32_t KeyHistory::record(uint64_t hash)
+{
+    Slot* set = setOf(hash);
+    uint32_t tag = tagOf(hash);
+    Slot* empty = nullptr;
+    for(size_t i = 0; i < kWays; i++){
+        if(set[i].tag == tag){
+            if(set[i].count < 255) ++set[i].count;
+            set[i].ref = 1;
+            return set[i].count;
+        }
+        if(set[i].tag == 0 && empty == nullptr) empty = &set[i];
+    }
+    if(empty == nullptr){
+        // 组满：时钟指针跳过并清除引用位为1的槽位，停在第一个引用位为0的槽位上，最多转一圈多
+        uint8_t& hand = hands_[hash & setMask_];
+        while(set[hand].ref){
+            set[hand].ref = 0;
+            hand = (hand + 1) % kWays;
+        }
+        empty = &set[hand];
+        hand = (hand + 1) % kWays;
+    }
+    empty->tag = tag;
+    empty->count = 1;
+    empty->ref = 0;
+    return 1;
+}
+
+inline void KeyHistory::erase(uint64_t hash)
+{
+    Slot* set = setOf(hash);
+    uint32_t tag = tagOf(hash);
+    for(size_t i = 0; i < kWays; i++){
+        if(set[i].tag == tag){
+            set[i] = Slot();
+            return;
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CacheHash.h"
+#include "FlatHashMap.h"
+#include "StdHashMap.h"
+#include "SwissHashMap.h"
+
+// key索引策略，作为缓存策略的模板参数，决定key到节点的映射使用哪种哈希表
+// 用法：typename Index::template Map<Key, T>，或typename Index::template Map<Key, T, Hash>指定哈希函数
+// 两种表默认使用CacheHash，调用方可以先用cacheHashOf算好哈希值再调用带hash参数的find/insert/erase，与分片共用同一个哈希值
+
+// 线性探测开放寻址哈希表，删除不留墓碑：删除时把其后同一簇中的元素依次前移，从不分配内存
+struct FlatIndex{
+    template<typename Key, typename T, typename Hash = CacheHash<Key>>
+    using Map = FlatHashMap<Key, T, Hash>;
+};
+
+// 控制字节分组哈希表，SSE2/NEON一次匹配16个标签，删除时按组后移、不留删除标记（默认）
+// 整数key下各规模的查找都快于FlatIndex和std::unordered_map，见src/IndexBench.cpp
+struct SwissIndex{
+    template<typename Key, typename T, typename Hash = CacheHash<Key>>
+    using Map = SwissHashMap<Key, T, Hash>;
+};
+
+// std::unordered_map，作为对比基准
+struct StdIndex{
+    template<typename Key, typename T, typename Hash = CacheHash<Key>>
+    using Map = StdHashMap<Key, T, Hash>;
+};
@@ -1,211 +1,340 @@
 #pragma once
+#include <algorithm>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <vector>
 
 #include "CachePolicy.h"
+#include "LockPolicy.h"
+#include "KeyIndex.h"
 #include "LfuList.h"
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>, typename Lock = std::mutex>
 class LfuCache : public cachePolicy<Key, Value> {
 public:
-    using Node = typename FreqList<Key, Value>::Node;
+    using List = FreqList<Key, Value>;
+    using Node = typename List::Node;
     using Nodeptr = std::shared_ptr<Node>;
-    using NodeMap = std::unordered_map<Key, Nodeptr>;
+    using NodeMap = typename Index::template Map<Key, Nodeptr, Hash>;
 
     LfuCache(int Capacity, int maxAverageNum=1000)
     : capacity_(Capacity)
-    , minFreq_(INT8_MAX)
     , maxAverageNum_(maxAverageNum)
     , curAverageNum_(0)
     , curTotalNum_(0)
+    , agingEpoch_(0)
+    , aging_(false)
+    , sweepList_(nullptr)
+    , sweepTarget_(nullptr)
+    , sweepEnd_(0)
+    , nodeMap_(Capacity > 0 ? Capacity : 0)
     {}
 
-    ~LfuCache() override{
-        purge();
-    };
+    ~LfuCache() override;
 
     void put(Key key, Value value) override;
     bool get(Key key, Value& value) override;
     Value get(Key key) override;
     void purge(); // 清空缓存
 
+    // 调整容量：减小时超出的条目不立即全部淘汰，之后每次插入新条目多淘汰几个
+    void setCapacity(int capacity);
+    size_t size();
+
+    // hash为cacheHashOf(Hash(), key)，由分片包装类算好传入，分片内不再重复计算
+    void put(Key key, Value value, size_t hash);
+    bool get(Key key, Value& value, size_t hash);
+
 private:
-    void putInternal(Key key, Value value);        // 添加缓存
-    void getInternal(Nodeptr node, Value& value);  // 获取缓存
+    void putInternal(Key key, Value value, size_t hash); // 添加缓存
+    void getInternal(Node* node, Value& value);    // 获取缓存
     void kickOut();                                // 移除缓存中的过期数据
-    void removeFromFreqList(Nodeptr node);         // 从频率列表中移除节点
-    void addToFreqList(Nodeptr node);              // 将节点添加到频率列表
+    void removeFromFreqList(Node* node);           // 从频率列表中移除节点，链表为空时回收
+    void moveToFreqList(Node* node, List* list);   // 将节点移动到指定频次链表的尾部
+    List* findFreqList(int freq, List* from);      // 从from出发查找频次为freq的链表，不存在时在对应位置创建
+    List* acquireFreqList(int freq, List* prev);   // 在prev之后插入频次为freq的空链表
+    void releaseFreqList(List* list);              // 摘除空链表并放回空闲池
     void addFreqNum();                             // 增加平均访问等频率
     void decreaseFreqNum(int num);                 // 减少平均访问等频率
     void handleOverMaxAverageNum();                // 处理当前平均访问频率超过上限的情况，“自我调节机制”
-    void updateMinFreq();                          // 更新最小访问频率
+    void advanceAging(int steps);                  // 推进增量老化，最多处理steps步
+    void decayNode(Node* node);                    // 节点落后于当前老化轮次时衰减其频次
 
 private:
+    static const int kAgingStepsPerOp = 4;        // 每次访问附带推进的老化步数
+    static const int kShrinkStep = 2;             // 容量减小后，每次调整容量或插入新条目时最多淘汰的条目数
+
     int capacity_;                                 // 容量
-    int minFreq_;                                  // 最小访问频率
     int maxAverageNum_;                            // 最大平均访问频率
     int curAverageNum_;                            // 当前平均访问频率
     int curTotalNum_;                              // 当前访问总频率
-    std::mutex mutex_;
+    int agingEpoch_;                               // 老化轮次，节点的epoch落后于它时频次尚未衰减
+    bool aging_;                                   // 是否有老化扫描正在进行
+    List* sweepList_;                              // 老化扫描当前所在的频次链表
+    List* sweepTarget_;                            // 上一个衰减节点落入的链表，衰减目标随扫描单调上升，从这里开始查找
+    int sweepEnd_;                                 // 本轮老化扫描的最后一个频次
+    Lock mutex_;                                   // 锁策略见LockPolicy.h，单线程使用时可取NullLock
     NodeMap nodeMap_;
 
-    std::unordered_map<int, std::shared_ptr<FreqList<Key, Value>>> freqToFreqList_;  // value为指向FreqList的指针，访问频次到频次链表的映射
+    List freqLists_;                               // 频次链表的哨兵，next_即最小频次链表，prev_即最大频次链表
+    std::vector<List*> freeLists_;                 // 回收的空链表，复用以避免反复分配
 };
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::put(Key key, Value value){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+LfuCache<Key, Value, Index, Hash, Lock>::~LfuCache(){
+    purge();
+    for(List* list : freeLists_){
+        delete list;
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value){
+    put(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value, size_t hash){
+    std::lock_guard<Lock> lock(mutex_);
     if(capacity_<=0) return;
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = nodeMap_.find(key);
+    Nodeptr* node = nodeMap_.find(key, hash);
     // 在缓存中找到key，更新value值，调用getInternal更新访问频次
-    if(it != nodeMap_.end()){
-        it->second->value = value;
-        getInternal(it->second, value);
+    if(node != nullptr){
+        (*node)->value = value;
+        getInternal(node->get(), value);
         return;
     }
     // 未找到缓存key，创建新节点
-    putInternal(key, value);
+    putInternal(key, value, hash);
 }
 
-template<typename Key, typename Value>
-bool LfuCache<Key, Value>::get(Key key, Value& value){
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = nodeMap_.find(key);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LfuCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value){
+    return get(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LfuCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value, size_t hash){
+    std::lock_guard<Lock> lock(mutex_);
+    Nodeptr* node = nodeMap_.find(key, hash);
     // 在缓存中找到key，调用getInternal更新访问频次
-    if(it != nodeMap_.end()){
-        getInternal(it->second, value);
+    if(node != nullptr){
+        getInternal(node->get(), value);
         return true;
     }
     return false;
 }
 
-template<typename Key, typename Value>
-Value LfuCache<Key, Value>::get(Key key){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+Value LfuCache<Key, Value, Index, Hash, Lock>::get(Key key){
     Value value;
     get(key, value);
     return value;
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::purge(){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::purge(){
+    // 先把所有频次链表放回空闲池，再释放节点
+    while(freqLists_.next_ != &freqLists_){
+        List* list = freqLists_.next_;
+        list->head_ = nullptr;
+        list->tail_ = nullptr;
+        releaseFreqList(list);
+    }
     nodeMap_.clear();
-    freqToFreqList_.clear();
+    curTotalNum_ = 0;
+    curAverageNum_ = 0;
+    aging_ = false;
+    sweepList_ = nullptr;
+    sweepTarget_ = nullptr;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::setCapacity(int capacity){
+    std::lock_guard<Lock> lock(mutex_);
+    capacity_ = capacity > 0 ? capacity : 0;
+    for(int i = 0; i < kShrinkStep && nodeMap_.size() > static_cast<size_t>(capacity_); i++){
+        kickOut();
+    }
+    if(capacity_ == 0){
+        while(!nodeMap_.empty()) kickOut();
+    }
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::getInternal(Nodeptr node, Value& value){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+size_t LfuCache<Key, Value, Index, Hash, Lock>::size(){
+    std::lock_guard<Lock> lock(mutex_);
+    return nodeMap_.size();
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::getInternal(Node* node, Value& value){
     value = node->value;
-    // 将当前节点在频次链表中删除，频次加1再添加到新的链表中
-    removeFromFreqList(node);
+    // 先补上尚未执行的老化衰减，频次加1，再移动到对应的频次链表
+    // 不衰减时目标就是当前链表的下一个，O(1)；衰减时从当前链表向前查找
+    decayNode(node);
     node->freq++;
-    addToFreqList(node);
-    
-    // 节点需要从旧链表中移动到新链表中
-    // 如果移动后该链表为空，则增加最小访问频率
-    if(node->freq-1 == minFreq_ && freqToFreqList_[node->freq-1]->isEmpty()){
-        minFreq_++;
-    }
+    moveToFreqList(node, findFreqList(node->freq, node->list));
     // 增加总访问频次和当前平均访问频次
     addFreqNum();
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::putInternal(Key key, Value value){
-    // 容量有限，淘汰最不常用的节点
-    if(nodeMap_.size() >= capacity_){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::putInternal(Key key, Value value, size_t hash){
+    // 容量有限，淘汰最不常用的节点；容量刚减小时可能超出多个，每次只多淘汰kShrinkStep个
+    for(int i = 0; i < kShrinkStep && nodeMap_.size() >= static_cast<size_t>(capacity_); i++){
         kickOut();
     }
-    // 创建新节点，添加到频次链表中，更新最小访问频次
-    Nodeptr node = std::make_shared<Node>(key, value);
-    nodeMap_[key] = node;
-    addToFreqList(node);
+    // 创建新节点，添加到频次为1的链表中
+    Nodeptr node = std::make_shared<Node>(key, value, hash);
+    node->epoch = agingEpoch_;
+    nodeMap_.insert(key, node, hash);
+    findFreqList(1, &freqLists_)->addNode(node.get());
     addFreqNum();
-    //因为新添加了节点，最小访问频次设置为1
-    minFreq_ = std::min(minFreq_, 1);
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::kickOut(){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::kickOut(){
     // 在最小频次链表中删除第一个节点
-    Nodeptr node = freqToFreqList_[minFreq_]->getFirstNode();
+    List* minList = freqLists_.next_;
+    if(minList == &freqLists_) return;
+    Node* node = minList->getFirstNode();
     removeFromFreqList(node);
-    nodeMap_.erase(node->key);
     decreaseFreqNum(node->freq);
+    Key key = node->key;
+    nodeMap_.erase(key, node->hash);
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::removeFromFreqList(Nodeptr node){
-    // 根据freq的值定位到对应的频次链表，然后将节点从链表中进行删除
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::removeFromFreqList(Node* node){
     if(!node) return;
-    auto freq = node->freq;
-    freqToFreqList_[freq]->removeNode(node);
+    List* list = node->list;
+    list->removeNode(node);
+    if(list->isEmpty()){
+        releaseFreqList(list);
+    }
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::addToFreqList(Nodeptr node){
-    // 根据freq的值定位到对应的频次链表，然后将节点添加到链表中
-    if(!node) return;
-    auto freq = node->freq;
-    // 如果频次链表不存在，创建一个新的频次链表
-    if(freqToFreqList_.find(freq) == freqToFreqList_.end()){
-        freqToFreqList_[node->freq] = std::make_shared<FreqList<Key, Value>>(node->freq);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::moveToFreqList(Node* node, List* list){
+    // 目标链表可能就是当前链表，先加入再回收，避免回收刚好要用的链表
+    List* oldList = node->list;
+    oldList->removeNode(node);
+    list->addNode(node);
+    if(oldList->isEmpty()){
+        releaseFreqList(oldList);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+typename LfuCache<Key, Value, Index, Hash, Lock>::List* LfuCache<Key, Value, Index, Hash, Lock>::findFreqList(int freq, List* from){
+    // 链表按频次升序排列，哨兵的频次为0
+    List* cur = from;
+    while(cur != &freqLists_ && cur->freq_ > freq){
+        cur = cur->prev_;
+    }
+    while(cur->next_ != &freqLists_ && cur->next_->freq_ <= freq){
+        cur = cur->next_;
+    }
+    if(cur != &freqLists_ && cur->freq_ == freq){
+        return cur;
     }
-    freqToFreqList_[freq]->addNode(node);
+    return acquireFreqList(freq, cur);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+typename LfuCache<Key, Value, Index, Hash, Lock>::List* LfuCache<Key, Value, Index, Hash, Lock>::acquireFreqList(int freq, List* prev){
+    List* list = nullptr;
+    if(freeLists_.empty()){
+        list = new List();
+    }else{
+        list = freeLists_.back();
+        freeLists_.pop_back();
+    }
+    list->freq_ = freq;
+    list->head_ = nullptr;
+    list->tail_ = nullptr;
+    list->prev_ = prev;
+    list->next_ = prev->next_;
+    prev->next_->prev_ = list;
+    prev->next_ = list;
+    return list;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::releaseFreqList(List* list){
+    // 老化扫描持有的链表被回收时，游标跟着移动到相邻链表
+    if(list == sweepList_) sweepList_ = list->next_;
+    if(list == sweepTarget_) sweepTarget_ = list->prev_;
+    list->prev_->next_ = list->next_;
+    list->next_->prev_ = list->prev_;
+    freeLists_.push_back(list);
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::addFreqNum(){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::addFreqNum(){
     curTotalNum_++;
     if(nodeMap_.empty()) curAverageNum_=0;
     else curAverageNum_ = curTotalNum_ / nodeMap_.size();
-    if(curAverageNum_ > maxAverageNum_){
+    if(curAverageNum_ > maxAverageNum_ && !aging_){
         handleOverMaxAverageNum();
     }
+    if(aging_){
+        advanceAging(kAgingStepsPerOp);
+    }
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::decreaseFreqNum(int num){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::decreaseFreqNum(int num){
     // 减少平均访问频次和总访问频次
     curTotalNum_ -= num;
     if(nodeMap_.empty()) curAverageNum_ =0;
     else curAverageNum_ = curTotalNum_ / nodeMap_.size();
 }
 
-// debug版本
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::handleOverMaxAverageNum(){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::handleOverMaxAverageNum(){
     // 自我调节机制，防止频次过高
-    // add：需要将总频次进行重新计算
-    curTotalNum_ = 0;
-
+    // 不再一次性遍历所有节点，只开启新的老化轮次：所有节点的频次都视为需要减去maxAverageNum_/2
+    // 被访问到的节点在getInternal中立即衰减，其余节点由advanceAging按频次从低到高分摊到后续操作中衰减
     if(nodeMap_.empty()) return;
-    for(auto it = nodeMap_.begin(); it != nodeMap_.end(); it++){
-        if(!it->second) continue;
-        Nodeptr node = it->second;
-        removeFromFreqList(node);
-        node->freq -= maxAverageNum_/2;
-        if(node->freq < 1) node->freq =1;
-        // add
-        curTotalNum_ += node->freq;
-
-        addToFreqList(node);
-    }
-    // add
-    if(nodeMap_.empty()) curAverageNum_ =0;
-    else curAverageNum_ = curTotalNum_ / nodeMap_.size();
-
-    updateMinFreq();
+    agingEpoch_++;
+    aging_ = true;
+    sweepList_ = freqLists_.next_;
+    sweepTarget_ = &freqLists_;
+    sweepEnd_ = freqLists_.prev_->freq_;
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::updateMinFreq(){
-    // 更新最小访问频率
-    minFreq_ = INT8_MAX;
-    for(const auto& pair : freqToFreqList_){
-        if(pair.second && !pair.second->isEmpty()){
-            minFreq_ = std::min(minFreq_, pair.first);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::advanceAging(int steps){
+    // 新加入链表的节点都排在尾部且已是当前轮次，所以每个频次链表中待衰减的节点总在头部
+    // 衰减后的节点只会移到更低的频次，扫描按频次升序进行，每个频次链表只需处理一次
+    while(steps-- > 0){
+        if(sweepList_ == &freqLists_ || sweepList_->freq_ > sweepEnd_){
+            aging_ = false;
+            sweepList_ = nullptr;
+            sweepTarget_ = nullptr;
+            curAverageNum_ = nodeMap_.empty() ? 0 : curTotalNum_ / nodeMap_.size();
+            return;
+        }
+        Node* node = sweepList_->getFirstNode();
+        if(node->epoch == agingEpoch_){
+            sweepList_ = sweepList_->next_;
+            continue;
         }
+        decayNode(node);
+        List* target = findFreqList(node->freq, sweepTarget_);
+        sweepTarget_ = target;
+        moveToFreqList(node, target);
     }
-    if(minFreq_ == INT8_MAX) minFreq_=1;
-}
\ No newline at end of file
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LfuCache<Key, Value, Index, Hash, Lock>::decayNode(Node* node){
+    // 同一时刻最多只有一轮老化在进行，落后的节点只需衰减一次
+    if(node->epoch == agingEpoch_) return;
+    int newFreq = std::max(node->freq - maxAverageNum_/2, 1);
+    curTotalNum_ -= node->freq - newFreq;
+    node->freq = newFreq;
+    node->epoch = agingEpoch_;
+}
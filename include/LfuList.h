@@ -1,71 +1,82 @@
 #pragma once
+#include <cstddef>
 #include <memory>
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
 class LfuCache;
 
+// 频次链表：同一访问频次的节点组成侵入式双向链表，头部最旧、尾部最新
+// 各频次链表按频次升序串成双向循环链表，由LfuCache持有哨兵；链表为空时立即摘除并回收复用
 template<typename Key, typename Value>
 class FreqList{
 private:
     struct Node{
         int freq;
+        int epoch;     // 最近一次按老化轮次衰减时的轮次
         Key key;
         Value value;
-        std::weak_ptr<Node> pre;
-        std::shared_ptr<Node> next;
+        size_t hash;   // key的CacheHash，淘汰时直接按哈希删除索引
+        Node* pre;
+        Node* next;
+        FreqList* list; // 所属频次链表
 
-        Node():freq(1), next() {}
-        Node(Key key, Value value):freq(1), key(key), value(value), next() {}
+        Node(Key key, Value value, size_t hash = 0):freq(1), epoch(0), key(key), value(value), hash(hash), pre(nullptr), next(nullptr), list(nullptr) {}
     };
 
-    using Nodeptr = std::shared_ptr<Node>;
     int freq_;
-    Nodeptr head_;
-    Nodeptr tail_;
+    FreqList* prev_;   // 频次更低的相邻链表
+    FreqList* next_;   // 频次更高的相邻链表
+    Node* head_;
+    Node* tail_;
 
 public:
-    // 初始化列表构造函数
-    explicit FreqList(int n):freq_(n){
-        head_ = std::make_shared<Node>();
-        tail_ = std::make_shared<Node>();
-        head_->next = tail_;
-        tail_->pre = head_;
-    }
+    FreqList():freq_(0), prev_(this), next_(this), head_(nullptr), tail_(nullptr) {}
     bool isEmpty() const;
-    void addNode(Nodeptr node);
-    void removeNode(Nodeptr node);
-    Nodeptr getFirstNode() const;
+    void addNode(Node* node);
+    void removeNode(Node* node);
+    Node* getFirstNode() const;
 
-    friend class LfuCache<Key, Value>;
+    template<typename K, typename V, typename I, typename H, typename L> friend class LfuCache;
 };
 
 template<typename Key, typename Value>
 bool FreqList<Key, Value>::isEmpty() const{
-    return head_->next == tail_;
+    return head_ == nullptr;
 }
 
 template<typename Key, typename Value>
-void FreqList<Key, Value>::addNode(Nodeptr node){
-    if(!node||!head_||!tail_) return;
-    auto lastNode = tail_->pre;
-    node->next = tail_;
-    node->pre = lastNode;
-    tail_->pre = node;
-    lastNode.lock()->next = node;
+void FreqList<Key, Value>::addNode(Node* node){
+    if(!node) return;
+    node->list = this;
+    node->next = nullptr;
+    node->pre = tail_;
+    if(tail_){
+        tail_->next = node;
+    }else{
+        head_ = node;
+    }
+    tail_ = node;
 }
 
 template<typename Key, typename Value>
-void FreqList<Key, Value>::removeNode(Nodeptr node){
-    if(!node||!head_||!tail_) return;
-    if(node->pre.expired()||!node->next) return;
-    auto preNode = node->pre.lock();
-    preNode->next = node->next;
-    node->next->pre = preNode;
+void FreqList<Key, Value>::removeNode(Node* node){
+    if(!node || node->list != this) return;
+    if(node->pre){
+        node->pre->next = node->next;
+    }else{
+        head_ = node->next;
+    }
+    if(node->next){
+        node->next->pre = node->pre;
+    }else{
+        tail_ = node->pre;
+    }
+    node->pre = nullptr;
     node->next = nullptr;
-    node->pre.reset();
-};
+    node->list = nullptr;
+}
 
 template<typename Key, typename Value>
-typename FreqList<Key,Value>::Nodeptr FreqList<Key, Value>::getFirstNode() const{
-    return head_->next;
+typename FreqList<Key,Value>::Node* FreqList<Key, Value>::getFirstNode() const{
+    return head_;
 }
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
+
+// LIRS（Jiang & Zhang）：按两次访问之间的间隔（重用距离）而不是最近一次访问时间区分冷热
+//   LIR：重用距离小的热数据，占容量的约99%，只有LIR会被降级，不会被直接淘汰
+//   HIR：其余数据，常驻的HIR放在队列Q中，淘汰总是发生在Q的头部
+// 栈S按访问时间记录LIR和最近访问过的HIR（包括已淘汰、只保留key的非常驻HIR），栈底始终是LIR；
+// 非常驻HIR在栈中再次被访问，说明它的重用距离比栈底的LIR小，二者交换身份
+// 循环扫描略大于缓存时，LIR集合保持稳定，扫描中的数据只在HIR的小队列中流转
+// S使用LruSlab的链表，Q和非常驻HIR链表使用SlabLinks，同一节点可以同时位于S与Q中
+// 非常驻HIR最多保留capacity个，超出时删除最早变为非常驻的key
+// 节点保存key的哈希，删除节点时按哈希删除索引，不再重新计算
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
+class LirsCache : public cachePolicy<Key, Value>
+{
+public:
+    using NodeSlab = LruSlab<Key, Value>;
+    using Nodemap = typename Index::template Map<Key, uint32_t, Hash>;  // key到节点下标的映射，包含非常驻HIR
+
+    LirsCache(int capacity)
+    : capacity_(capacity > 0 ? capacity : 0)
+    , hirCapacity_(capacity_ / 100 > 0 ? capacity_ / 100 : 1)
+    , lirCapacity_(capacity_ > hirCapacity_ ? capacity_ - hirCapacity_ : 0)
+    , nonResidentCapacity_(capacity_)
+    , lirCount_(0)
+    , residentCount_(0)
+    , nonResidentCount_(0)
+    , nodeMap_(capacity_ * 2)
+    , slab_(capacity_ * 2, 1)
+    , links_(capacity_ * 2 + 1, kListNum)
+    , state_(capacity_ * 2 + 1, kHir)
+    , inStack_(capacity_ * 2 + 1, 0)
+    {}
+
+    ~LirsCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+    void remove(Key key);
+
+    // hash为cacheHashOf(Hash(), key)，由分片包装类算好传入，分片内不再重复计算
+    void put(Key key, Value value, size_t hash);
+    bool get(Key key, Value& value, size_t hash);
+
+private:
+    enum State : uint8_t { kLir = 0, kHir = 1, kNonResident = 2 };
+    static const size_t kStack = 0;        // LruSlab中的栈S：头部为栈底，尾部为栈顶
+    static const size_t kQueue = 0;        // SlabLinks中的常驻HIR队列Q：头部最先淘汰
+    static const size_t kNonResidentList = 1; // SlabLinks中的非常驻HIR链表：头部最早变为非常驻
+    static const size_t kListNum = 2;
+
+    void onHit(uint32_t node);                        // 访问常驻节点
+    void promote(uint32_t node);                      // 栈中的HIR升为LIR，必要时降级栈底LIR
+    void addNewNode(const Key& key, const Value& value, size_t hash);
+    void evictResidentHir();                          // 淘汰Q头部的常驻HIR
+    void pushStack(uint32_t node);                    // 放到栈顶
+    void pruneStack();                                // 栈剪枝：移除栈底的HIR，使栈底为LIR
+    void removeNode(uint32_t node);                   // 彻底删除节点
+
+private:
+    size_t capacity_;
+    size_t hirCapacity_;           // 常驻HIR的目标个数
+    size_t lirCapacity_;           // LIR个数上限
+    size_t nonResidentCapacity_;   // 非常驻HIR个数上限
+    size_t lirCount_;
+    size_t residentCount_;         // LIR与常驻HIR的个数
+    size_t nonResidentCount_;
+    Nodemap nodeMap_;
+    NodeSlab slab_;
+    SlabLinks links_;
+    std::vector<uint8_t> state_;   // 节点下标 -> LIR/常驻HIR/非常驻HIR
+    std::vector<uint8_t> inStack_; // 节点下标 -> 是否在栈S中
+    std::mutex mutex_;
+};
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::put(Key key, Value value)
+{
+    put(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::put(Key key, Value value, size_t hash)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found == nullptr){
+        addNewNode(key, value, hash);
+        return;
+    }
+    uint32_t node = *found;
+    if(state_[node] != kNonResident){
+        slab_[node].setValue(value);
+        onHit(node);
+        return;
+    }
+    // 非常驻HIR再次出现：先摘出非常驻链表并标为常驻HIR（暂不进Q），避免腾位置时被删掉或淘汰
+    links_.unlink(node);
+    --nonResidentCount_;
+    state_[node] = kHir;
+    pruneStack();
+    if(residentCount_ >= capacity_){
+        evictResidentHir();
+    }
+    slab_[node].setValue(value);
+    ++residentCount_;
+    // 曾在栈中，说明重用距离小于栈底的LIR
+    promote(node);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool LirsCache<Key, Value, Index, Hash>::get(Key key, Value& value)
+{
+    return get(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool LirsCache<Key, Value, Index, Hash>::get(Key key, Value& value, size_t hash)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found == nullptr || state_[*found] == kNonResident) return false;
+    // 剪枝可能删除其他key，find返回的指针随之失效，先取出下标
+    uint32_t node = *found;
+    onHit(node);
+    value = slab_[node].getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+Value LirsCache<Key, Value, Index, Hash>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::remove(Key key)
+{
+    size_t hash = cacheHashOf(Hash(), key);
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found == nullptr) return;
+    removeNode(*found);
+    pruneStack();
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::onHit(uint32_t node)
+{
+    if(state_[node] == kLir){
+        pushStack(node);
+        pruneStack();
+        return;
+    }
+    // 常驻HIR
+    if(inStack_[node]){
+        links_.unlink(node);
+        promote(node);
+    }else{
+        pushStack(node);
+        links_.moveToBack(kQueue, node);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::promote(uint32_t node)
+{
+    state_[node] = kLir;
+    ++lirCount_;
+    pushStack(node);
+    pruneStack();
+    if(lirCount_ > lirCapacity_){
+        // 剪枝后栈底一定是LIR，降级为常驻HIR，离开栈进入Q的尾部
+        uint32_t bottom = slab_.front(kStack);
+        slab_.unlink(bottom);
+        inStack_[bottom] = 0;
+        state_[bottom] = kHir;
+        --lirCount_;
+        links_.pushBack(kQueue, bottom);
+    }
+    pruneStack();
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::addNewNode(const Key& key, const Value& value, size_t hash)
+{
+    if(residentCount_ >= capacity_){
+        evictResidentHir();
+    }
+    uint32_t node = slab_.allocate(key, value, hash);
+    ++residentCount_;
+    nodeMap_.insert(key, node, hash);
+    if(lirCount_ < lirCapacity_){
+        // LIR集合未满时新数据直接成为LIR
+        state_[node] = kLir;
+        ++lirCount_;
+        pushStack(node);
+        pruneStack();
+        return;
+    }
+    state_[node] = kHir;
+    pushStack(node);
+    links_.pushBack(kQueue, node);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::evictResidentHir()
+{
+    uint32_t node = links_.front(kQueue);
+    if(node == SlabLinks::npos){
+        // Q为空（LIR占满了缓存），淘汰栈底的LIR
+        node = slab_.front(kStack);
+        if(node == NodeSlab::npos) return;
+        removeNode(node);
+        pruneStack();
+        return;
+    }
+    if(!inStack_[node]){
+        // 不在栈中，不再需要记录
+        removeNode(node);
+        return;
+    }
+    // 仍在栈中，丢掉value变为非常驻HIR
+    links_.unlink(node);
+    --residentCount_;
+    state_[node] = kNonResident;
+    slab_[node].setValue(Value());
+    links_.pushBack(kNonResidentList, node);
+    ++nonResidentCount_;
+    if(nonResidentCount_ > nonResidentCapacity_){
+        removeNode(links_.front(kNonResidentList));
+        pruneStack();
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::pushStack(uint32_t node)
+{
+    if(inStack_[node]){
+        slab_.moveToBack(kStack, node);
+    }else{
+        slab_.pushBack(kStack, node);
+        inStack_[node] = 1;
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::pruneStack()
+{
+    for(;;){
+        uint32_t bottom = slab_.front(kStack);
+        if(bottom == NodeSlab::npos || state_[bottom] == kLir) return;
+        if(state_[bottom] == kNonResident){
+            removeNode(bottom);
+        }else{
+            // 常驻HIR离开栈，仍留在Q中
+            slab_.unlink(bottom);
+            inStack_[bottom] = 0;
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LirsCache<Key, Value, Index, Hash>::removeNode(uint32_t node)
+{
+    switch(state_[node]){
+        case kLir:
+            --lirCount_;
+            --residentCount_;
+            break;
+        case kHir:
+            links_.unlink(node);
+            --residentCount_;
+            break;
+        case kNonResident:
+            links_.unlink(node);
+            --nonResidentCount_;
+            break;
+    }
+    if(inStack_[node]){
+        slab_.unlink(node);
+        inStack_[node] = 0;
+    }
+    nodeMap_.erase(slab_[node].getKey(), slab_[node].getHash());
+    slab_.release(node);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "SharedSpinLock.h"
+
+// 缓存的锁策略，作为LruCache、LfuCache、ArcCache及其分片版本的Lock模板参数，默认std::mutex
+// 各策略都提供lock/unlock，可以直接配合std::lock_guard使用
+//   NullLock：不加锁，只用于单线程场景
+//   SpinLock：TTAS自旋锁，临界区很短时比std::mutex少一次进出内核
+//   AdaptiveLock：先自旋一段时间，仍拿不到再交给std::mutex挂起线程，兼顾短临界区和长时间等待
+//   SharedSpinLock：读写自旋锁（C++11没有std::shared_mutex）；LruCache的get在它下面只加共享锁，
+//                   命中记录写入AccessBuffer后批量回放，其他缓存的get也要调整链表，只用到独占加锁
+
+class NullLock
+{
+public:
+    void lock() {}
+    void unlock() {}
+    bool try_lock() { return true; }
+    void lock_shared() {}
+    void unlock_shared() {}
+};
+
+// 先只读等待锁变为空闲（只在本核缓存中自旋，不抢占缓存行），空闲后再尝试交换；
+// 失败后退避等待的次数成倍增加，超过上限改为让出时间片
+class SpinLock
+{
+public:
+    SpinLock() : locked_(false) {}
+    SpinLock(const SpinLock&) = delete;
+    SpinLock& operator=(const SpinLock&) = delete;
+
+    void lock();
+    void unlock() { locked_.store(false, std::memory_order_release); }
+    bool try_lock();
+
+private:
+    static const int kMaxBackoff = 1024;  // 单次退避的最大自旋次数
+
+    std::atomic<bool> locked_;
+};
+
+inline bool SpinLock::try_lock()
+{
+    return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+}
+
+inline void SpinLock::lock()
+{
+    int backoff = 1;
+    for(;;){
+        if(!locked_.exchange(true, std::memory_order_acquire)) return;
+        while(locked_.load(std::memory_order_relaxed)){
+            if(backoff <= kMaxBackoff){
+                for(int i = 0; i < backoff; i++) SharedSpinLock::cpuRelax();
+                backoff <<= 1;
+            }else{
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+// 自旋阶段用try_lock试探，不改变std::mutex的语义；持锁线程很快释放时不会进入futex等待
+class AdaptiveLock
+{
+public:
+    AdaptiveLock() = default;
+    AdaptiveLock(const AdaptiveLock&) = delete;
+    AdaptiveLock& operator=(const AdaptiveLock&) = delete;
+
+    void lock();
+    void unlock() { mutex_.unlock(); }
+    bool try_lock() { return mutex_.try_lock(); }
+
+private:
+    static const int kSpinCount = 100;  // 挂起前的试探次数
+
+    std::mutex mutex_;
+};
+
+inline void AdaptiveLock::lock()
+{
+    for(int i = 0; i < kSpinCount; i++){
+        if(mutex_.try_lock()) return;
+        SharedSpinLock::cpuRelax();
+    }
+    mutex_.lock();
+}
+
+// 锁是否支持共享加锁，LruCache据此选择get的实现
+template<typename Lock>
+struct IsSharedLock : std::false_type {};
+
+template<>
+struct IsSharedLock<SharedSpinLock> : std::true_type {};
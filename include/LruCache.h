@@ -1,138 +1,317 @@
 #pragma once
 
 #include <cstring>
-#include <memory>
+#include <cstdint>
 #include <mutex>
-#include <unordered_map>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "AccessBuffer.h"
 #include "CachePolicy.h"
-#include "LruNode.h"
+#include "LockPolicy.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
 
-template<typename Key,typename Value>
+// Lock为读写锁（IsSharedLock，如SharedSpinLock）时，get只加共享锁查找并读取value，
+// 命中记录写入AccessBuffer，缓冲过半时尝试加独占锁、写满时加独占锁批量调整LRU顺序（BP-Wrapper）；
+// put、remove先回放缓冲再修改，淘汰时看到的LRU顺序只缺少尚未回放的少量命中
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>, typename Lock = std::mutex>
 class LruCache : public cachePolicy<Key,Value>{
 public:
     using LruNodeType = LruNode<Key, Value>;
-    using Nodeptr = std::shared_ptr<LruNodeType>;
-    using Nodemap = std::unordered_map<Key, Nodeptr>;
+    using NodeSlab = LruSlab<Key, Value>;
+    using Nodemap = typename Index::template Map<Key, uint32_t, Hash>;  // key到节点下标的映射
 
-    LruCache(int capacity):capacity_(capacity){ initializeList(); }
+    // promotionRatio：命中的节点距最近使用端不超过capacity * promotionRatio个位置时不移动，0表示每次命中都移动
+    LruCache(int capacity, double promotionRatio = 0)
+    :capacity_(capacity)
+    ,promotionRatio_(promotionRatio)
+    ,generation_(0)
+    ,promoteWindow_(promotionWindow(capacity, promotionRatio))
+    ,nodeMap_(capacity > 0 ? capacity : 0)
+    ,slab_(capacity > 0 ? capacity : 0)
+    ,accessBuffer_(IsSharedLock<Lock>::value)
+    {}
     ~LruCache() override = default;
 
     void put(Key key, Value value) override;
     bool get(Key key, Value& value) override;
     Value get(Key key) override;
     void remove(Key key);
+
+    // 调整容量：增大时扩充节点池，减小时超出的条目不立即全部淘汰，之后每次插入新条目多淘汰几个，把代价分摊开
+    void setCapacity(int capacity);
+    size_t size();
+
+    // 供分片包装类在分片之间迁移条目，见SliceTable
+    bool take(const Key& key, size_t hash, Value& value);          // 移出条目并取回value，不存在时返回false
+    bool putIfAbsent(Key key, Value value, size_t hash);           // 不存在时插入，已存在时不覆盖
+    bool peek(const Key& key, size_t hash, Value& value);          // 读取value，不改变访问顺序
+    bool eraseIfEqual(const Key& key, size_t hash, const Value& value); // value未改变时移出条目
+    // 从cursor（初始为0）起最多扫描limit个节点位置，收集哈希满足pred(hash)的key及其哈希；整个分片扫描完时返回true
+    template<typename Pred>
+    bool collectKeys(Pred pred, size_t& cursor, size_t limit, std::vector<std::pair<Key, size_t>>& keys);
+
+    // hash为cacheHashOf(Hash(), key)，由分片包装类算好传入，分片内不再重复计算
+    void put(Key key, Value value, size_t hash);
+    bool get(Key key, Value& value, size_t hash);
+    void remove(Key key, size_t hash);
 private:
-    void initializeList();
-    void addNewNode(Key key, Value value);
-    void updateExistingNode(Nodeptr node, Value value);
-    void moveToMostRecent(Nodeptr node);
-    void removeNode(Nodeptr node);
+    bool getLocked(const Key& key, Value& value, size_t hash, std::false_type);   // 独占锁下查找并调整顺序
+    bool getLocked(const Key& key, Value& value, size_t hash, std::true_type);    // 共享锁下查找，顺序调整写入缓冲
+    void drainAccessBuffer();                      // 回放缓冲中的命中记录，需持有独占锁
+    static uint32_t promotionWindow(int capacity, double promotionRatio);
+    void addNewNode(Key key, Value value, size_t hash);
+    void updateExistingNode(uint32_t node, Value value);
+    void moveToMostRecent(uint32_t node);
+    void removeNode(uint32_t node);
     void evictLeastRecent();
-    void insertNode(Nodeptr node);
+    void insertNode(uint32_t node);
 private:
+    static const size_t kLruList = 0;  // slab中唯一的链表：头部最久未使用，尾部最近使用
+    static const int kShrinkStep = 2;  // 容量减小后，每次调整容量或插入新条目时最多淘汰的条目数
+
     int capacity_;
+    double promotionRatio_;
+    // 提升节流：节点移到尾部时记下代数，之后每有一个节点移到尾部代数加一；
+    // 代数差小于promoteWindow_，说明排在它后面的节点少于promoteWindow_个，命中时不必移动
+    uint32_t generation_;
+    uint32_t promoteWindow_;
     Nodemap nodeMap_;
-    std::mutex mutex_;
-    Nodeptr dummyHead_;
-    Nodeptr dummyTail_;
+    Lock mutex_;   // 锁策略见LockPolicy.h，单线程使用时可取NullLock
+    NodeSlab slab_;
+    AccessBuffer accessBuffer_;  // 只在读写锁下分配
 };
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::put(Key key, Value value){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value){
+    put(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::put(Key key, Value value, size_t hash){
+    std::lock_guard<Lock> lock(mutex_);
     if(capacity_<=0) return;
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = nodeMap_.find(key);
-    if(it != nodeMap_.end()){
-        updateExistingNode(it->second, value);
+    drainAccessBuffer();
+    uint32_t* node = nodeMap_.find(key, hash);
+    if(node != nullptr){
+        updateExistingNode(*node, value);
         return;
     }
-    addNewNode(key, value);
+    addNewNode(key, value, hash);
 }
 
-template<typename Key, typename Value>
-bool LruCache<Key, Value>::get(Key key, Value& value){
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = nodeMap_.find(key);
-    if(it != nodeMap_.end()){
-        moveToMostRecent(it->second);
-        value = it->second->getValue();
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value){
+    return get(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::get(Key key, Value& value, size_t hash){
+    return getLocked(key, value, hash, std::integral_constant<bool, IsSharedLock<Lock>::value>());
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::getLocked(const Key& key, Value& value, size_t hash, std::false_type){
+    std::lock_guard<Lock> lock(mutex_);
+    uint32_t* node = nodeMap_.find(key, hash);
+    if(node != nullptr){
+        moveToMostRecent(*node);
+        value = slab_[*node].getValue();
         return true;
     }
     return false;
 }
 
-template<typename Key, typename Value>
-Value LruCache<Key, Value>::get(Key key){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::getLocked(const Key& key, Value& value, size_t hash, std::true_type){
+    uint32_t node;
+    {
+        SharedLockGuard<Lock> lock(mutex_);
+        uint32_t* found = nodeMap_.find(key, hash);
+        if(found == nullptr) return false;
+        node = *found;
+        value = slab_[node].getValue();
+    }
+    // 释放共享锁后再记录，节点此时可能已被淘汰，回放时校验
+    AccessBuffer::Status status = accessBuffer_.record(node, hash);
+    if(status == AccessBuffer::kFull){
+        std::lock_guard<Lock> lock(mutex_);
+        drainAccessBuffer();
+    }else if(status == AccessBuffer::kDrainable && mutex_.try_lock()){
+        drainAccessBuffer();
+        mutex_.unlock();
+    }
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+Value LruCache<Key, Value, Index, Hash, Lock>::get(Key key){
     Value value{};
     get(key, value);
     return value;
 }
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::remove(Key key){
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = nodeMap_.find(key);
-    if(it != nodeMap_.end()){
-        removeNode(it->second);
-        nodeMap_.erase(it);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::remove(Key key){
+    remove(key, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::remove(Key key, size_t hash){
+    std::lock_guard<Lock> lock(mutex_);
+    drainAccessBuffer();
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found != nullptr){
+        uint32_t node = *found;
+        removeNode(node);
+        nodeMap_.erase(key, hash);
+        slab_.release(node);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::setCapacity(int capacity){
+    std::lock_guard<Lock> lock(mutex_);
+    drainAccessBuffer();
+    capacity_ = capacity > 0 ? capacity : 0;
+    promoteWindow_ = promotionWindow(capacity_, promotionRatio_);
+    slab_.grow(capacity_);
+    for(int i = 0; i < kShrinkStep && nodeMap_.size() > static_cast<size_t>(capacity_); i++){
+        evictLeastRecent();
+    }
+    if(capacity_ == 0){
+        while(nodeMap_.size() > 0) evictLeastRecent();
     }
 }
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::initializeList(){
-    dummyHead_ = std::make_shared<LruNodeType>(Key{}, Value{});
-    dummyTail_ = std::make_shared<LruNodeType>(Key{}, Value{});
-    dummyHead_->next = dummyTail_;
-    dummyTail_->prev = dummyHead_;
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+size_t LruCache<Key, Value, Index, Hash, Lock>::size(){
+    std::lock_guard<Lock> lock(mutex_);
+    return nodeMap_.size();
 }
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::addNewNode(Key key, Value value){
-    if(nodeMap_.size() >= capacity_){
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::take(const Key& key, size_t hash, Value& value){
+    std::lock_guard<Lock> lock(mutex_);
+    drainAccessBuffer();
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found == nullptr) return false;
+    uint32_t node = *found;
+    value = slab_[node].getValue();
+    removeNode(node);
+    nodeMap_.erase(key, hash);
+    slab_.release(node);
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::peek(const Key& key, size_t hash, Value& value){
+    std::lock_guard<Lock> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found == nullptr) return false;
+    value = slab_[*found].getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::eraseIfEqual(const Key& key, size_t hash, const Value& value){
+    std::lock_guard<Lock> lock(mutex_);
+    drainAccessBuffer();
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found == nullptr || !(slab_[*found].getValue() == value)) return false;
+    uint32_t node = *found;
+    removeNode(node);
+    nodeMap_.erase(key, hash);
+    slab_.release(node);
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+bool LruCache<Key, Value, Index, Hash, Lock>::putIfAbsent(Key key, Value value, size_t hash){
+    std::lock_guard<Lock> lock(mutex_);
+    if(capacity_<=0) return false;
+    drainAccessBuffer();
+    if(nodeMap_.find(key, hash) != nullptr) return false;
+    addNewNode(key, value, hash);
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+template<typename Pred>
+bool LruCache<Key, Value, Index, Hash, Lock>::collectKeys(Pred pred, size_t& cursor, size_t limit, std::vector<std::pair<Key, size_t>>& keys){
+    std::lock_guard<Lock> lock(mutex_);
+    // 按节点下标扫描：节点的下标在分片内不变，两批之间的插入、删除不会让尚未扫描的条目错位
+    size_t index = cursor > slab_.dataBegin() ? cursor : slab_.dataBegin();
+    size_t end = index + limit < slab_.dataEnd() ? index + limit : slab_.dataEnd();
+    for(; index < end; index++){
+        if(!slab_.allocated(static_cast<uint32_t>(index))) continue;
+        const LruNodeType& node = slab_[static_cast<uint32_t>(index)];
+        if(pred(node.getHash())) keys.push_back(std::make_pair(node.getKey(), node.getHash()));
+    }
+    cursor = index;
+    return index == slab_.dataEnd();
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::addNewNode(Key key, Value value, size_t hash){
+    // 容量刚减小时可能超出多个，每次只多淘汰kShrinkStep个
+    for(int i = 0; i < kShrinkStep && nodeMap_.size() >= static_cast<size_t>(capacity_); i++){
         evictLeastRecent();
     }
-    Nodeptr newNode = std::make_shared<LruNodeType>(key, value);
+    uint32_t newNode = slab_.allocate(key, value, hash);
     insertNode(newNode);
-    nodeMap_[key]= newNode;
+    nodeMap_.insert(key, newNode, hash);
 }
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::updateExistingNode(Nodeptr node, Value value){
-    node->setValue(value);
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::updateExistingNode(uint32_t node, Value value){
+    slab_[node].setValue(value);
     moveToMostRecent(node);
 }
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::moveToMostRecent(Nodeptr node){
-    removeNode(node);
-    insertNode(node);
-}
-
-template<typename Key, typename Value>
-void LruCache<Key, Value>::removeNode(Nodeptr node){
-    if(!node->prev.expired() && node->next){
-        auto prevNode = node->prev.lock();
-        auto nextNode = node->next;
-        prevNode->next = nextNode;
-        nextNode->prev = prevNode;
-        node->next = nullptr;
-        node->prev.reset();
-    }
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::moveToMostRecent(uint32_t node){
+    // 无符号减法，代数回绕后仍然正确
+    if(generation_ - slab_[node].getStamp() < promoteWindow_) return;
+    slab_.moveToBack(kLruList, node);
+    slab_[node].setStamp(++generation_);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::removeNode(uint32_t node){
+    slab_.unlink(node);
 }
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::evictLeastRecent(){
-    Nodeptr leastNode = dummyHead_->next;
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::evictLeastRecent(){
+    uint32_t leastNode = slab_.front(kLruList);
+    if(leastNode == NodeSlab::npos) return;
     removeNode(leastNode);
-    nodeMap_.erase(leastNode->getKey());
+    nodeMap_.erase(slab_[leastNode].getKey(), slab_[leastNode].getHash());
+    slab_.release(leastNode);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::insertNode(uint32_t node){
+    slab_.pushBack(kLruList, node);
+    slab_[node].setStamp(++generation_);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+uint32_t LruCache<Key, Value, Index, Hash, Lock>::promotionWindow(int capacity, double promotionRatio){
+    if(capacity <= 0 || promotionRatio <= 0) return 0;
+    if(promotionRatio > 1) promotionRatio = 1;
+    return static_cast<uint32_t>(capacity * promotionRatio);
 }
 
-template<typename Key, typename Value>
-void LruCache<Key, Value>::insertNode(Nodeptr node){
-    auto lastNode = dummyTail_->prev.lock();
-    lastNode->next = node;
-    node->prev = lastNode;
-    node->next = dummyTail_;
-    dummyTail_->prev = node;
+template<typename Key, typename Value, typename Index, typename Hash, typename Lock>
+void LruCache<Key, Value, Index, Hash, Lock>::drainAccessBuffer(){
+    accessBuffer_.drain([this](uint32_t node, uint32_t hash){
+        // 记录之后节点可能已被释放或分配给其他key，跳过
+        if(slab_.allocated(node) && static_cast<uint32_t>(slab_[node].getHash()) == hash){
+            moveToMostRecent(node);
+        }
+    });
 }
@@ -1,76 +1,136 @@
 #pragma once
-#include <memory>
-#include <unordered_map>
 
-#include "LruCache.h"
+#include <cstdint>
+#include <mutex>
 
-template<typename Key, typename Value>
-class LruKCache : public LruCache<Key, Value> {
+#include "CachePolicy.h"
+#include "KeyHistory.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
+
+// 访问次数达到k次的数据才进入主缓存；未达到k次的key只在定长的KeyHistory中计数，不保存value
+// 内存上限为capacity个缓存节点加上historyCapacity个8字节的历史槽位
+// 主缓存与访问历史由同一把锁保护，每次操作只加一次锁、只查一次key索引，整个操作是原子的
+// key的哈希每次操作只算一次，访问历史和key索引共用，节点保存哈希供淘汰时使用
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
+class LruKCache : public cachePolicy<Key, Value> {
 public:
+    using NodeSlab = LruSlab<Key, Value>;
+    using Nodemap = typename Index::template Map<Key, uint32_t, Hash>;  // key到节点下标的映射
+
     LruKCache(int capacity, int historyCapacity, int k)
-    :LruCache<Key, Value>(capacity)
-    ,historyList_(std::unique_ptr<LruCache<Key, size_t>>(new LruCache<Key, size_t>(historyCapacity)))  // 设置为独占，当LruKCache销毁时也会被销毁
-    ,k_(k) {}
+    :capacity_(capacity > 0 ? capacity : 0)
+    ,k_(k > 0 ? static_cast<uint32_t>(k) : 1)
+    ,nodeMap_(capacity_)
+    ,slab_(capacity_)
+    ,history_(historyCapacity > 0 ? historyCapacity : 0)
+    {}
+    ~LruKCache() override = default;
 
-    using LruCache<Key, Value>::get; // 子类重写会覆盖父类的函数实现，这里进行显式说明！
-    Value get(Key key);
-    void put(Key key, Value value);
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+    void remove(Key key);
+
+    // hash为cacheHashOf(Hash(), key)，由分片包装类算好传入，分片内不再重复计算
+    void put(Key key, Value value, size_t hash);
+    bool get(Key key, Value& value, size_t hash);
 private:
-    int k_;
-    std::unique_ptr<LruCache<Key, size_t>> historyList_;  // 访问数据的历史记录
-    std::unordered_map<Key, Value> historyValueMap_;     // 存储未达到k次访问的数据值。
-};
+    void addNewNode(const Key& key, const Value& value, size_t hash);
+    void evictLeastRecent();
+private:
+    static const size_t kLruList = 0;  // slab中唯一的链表：头部最久未使用，尾部最近使用
 
-template<typename Key, typename Value>
-Value LruKCache<Key, Value>::get(Key key){
-    Value value{};
-    bool inMainCache = LruCache<Key, Value>::get(key, value);
-    
-    // 数据在主缓存中
-    if(inMainCache){
-        return value;
-    }
+    size_t capacity_;
+    uint32_t k_;
+    Nodemap nodeMap_;
+    NodeSlab slab_;
+    KeyHistory history_;       // 访问数据的历史记录，只有指纹和次数
+    std::mutex mutex_;
+};
 
-    size_t historyCount = historyList_->get(key);
-    historyCount++;
-    historyList_->put(key, historyCount);
-    
-    // 数据不在主缓存中，但是访问次数达到k次
-    if(historyCount >= k_){
-        auto it = historyValueMap_.find(key);
-        if(it != historyValueMap_.end()){
-            Value storedValue = it->second;
-            historyList_->remove(key);
-            historyValueMap_.erase(it);
-            LruCache<Key, Value>::put(key, storedValue);
-            return storedValue;
-        }
-    }
-    return value;
+template<typename Key, typename Value, typename Index, typename Hash>
+void LruKCache<Key, Value, Index, Hash>::put(Key key, Value value){
+    put(key, value, cacheHashOf(Hash(), key));
 }
 
-template<typename Key, typename Value>
-void LruKCache<Key, Value>::put(Key key, Value value){
-    Value existingValue{};
-    bool inMainCache = LruCache<Key, Value>::get(key, existingValue);
+template<typename Key, typename Value, typename Index, typename Hash>
+void LruKCache<Key, Value, Index, Hash>::put(Key key, Value value, size_t hash){
+    if(capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* node = nodeMap_.find(key, hash);
 
     // 在主缓存中，更新
-    if(inMainCache){
-        LruCache<Key, Value>::put(key, value);
+    if(node != nullptr){
+        slab_[*node].setValue(value);
+        slab_.moveToBack(kLruList, *node);
         return;
     }
 
     // 不在主缓存中，更新访问历史
-    size_t historyCount = historyList_->get(key);
-    historyCount++;
-    historyList_->put(key, historyCount);
-    historyValueMap_[key] = value;
+    if(history_.record(hash) < k_) return;
 
     // 达到k次访问阈值
-    if(historyCount >= k_){
-        historyList_->remove(key);
-        historyValueMap_.erase(key);
-        LruCache<Key, Value>::put(key, value);
+    history_.erase(hash);
+    addNewNode(key, value, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool LruKCache<Key, Value, Index, Hash>::get(Key key, Value& value){
+    return get(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool LruKCache<Key, Value, Index, Hash>::get(Key key, Value& value, size_t hash){
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* node = nodeMap_.find(key, hash);
+    if(node != nullptr){
+        slab_.moveToBack(kLruList, *node);
+        value = slab_[*node].getValue();
+        return true;
     }
+    // 历史记录中没有value，这次访问只计数，等下一次put达到k次时再进入主缓存
+    history_.record(hash);
+    return false;
 }
 
+template<typename Key, typename Value, typename Index, typename Hash>
+Value LruKCache<Key, Value, Index, Hash>::get(Key key){
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LruKCache<Key, Value, Index, Hash>::remove(Key key){
+    size_t hash = cacheHashOf(Hash(), key);
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found != nullptr){
+        uint32_t node = *found;
+        slab_.unlink(node);
+        nodeMap_.erase(key, hash);
+        slab_.release(node);
+        return;
+    }
+    history_.erase(hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LruKCache<Key, Value, Index, Hash>::addNewNode(const Key& key, const Value& value, size_t hash){
+    if(nodeMap_.size() >= capacity_){
+        evictLeastRecent();
+    }
+    uint32_t node = slab_.allocate(key, value, hash);
+    slab_.pushBack(kLruList, node);
+    nodeMap_.insert(key, node, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void LruKCache<Key, Value, Index, Hash>::evictLeastRecent(){
+    uint32_t leastNode = slab_.front(kLruList);
+    if(leastNode == NodeSlab::npos) return;
+    slab_.unlink(leastNode);
+    nodeMap_.erase(slab_[leastNode].getKey(), slab_[leastNode].getHash());
+    slab_.release(leastNode);
+}
@@ -1,25 +1,30 @@
 #pragma once
-#include <memory>
+#include <cstddef>
+#include <cstdint>
 
 template<typename Key, typename Value>
-class LruCache;
+class LruSlab;
 
+// 节点不再持有智能指针，前驱/后继均为节点在LruSlab中的32位下标
 template<typename Key, typename Value>
 class LruNode{
     private:
         Key key;
         Value value;
-        size_t accessCount;
-        std::weak_ptr<LruNode<Key, Value>> prev;
-        std::shared_ptr<LruNode<Key, Value>> next;
+        size_t hash;          // key的CacheHash，淘汰时直接按哈希删除索引
+        uint32_t prev;
+        uint32_t next;
+        uint32_t stamp;       // 最近一次移到链表尾部时的代数，由使用者维护，LruSlab不读写
     public:
-        LruNode(Key key, Value value):key(key), value(value), accessCount(1), prev(), next() {}
+        LruNode():key(), value(), hash(0), prev(0), next(0), stamp(0) {}
+        LruNode(Key key, Value value):key(key), value(value), hash(0), prev(0), next(0), stamp(0) {}
 
         Key getKey() const { return key; }
         Value getValue() const { return value; }
         void setValue(const Value& value) { this->value = value;}
-        size_t getAccessCount() const { return accessCount; }
-        void incrementAccessCount() { ++accessCount; }
+        size_t getHash() const { return hash; }
+        uint32_t getStamp() const { return stamp; }
+        void setStamp(uint32_t stamp) { this->stamp = stamp; }
 
-        friend class LruCache<Key, Value>;
-};
\ No newline at end of file
+        friend class LruSlab<Key, Value>;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "LruNode.h"
+
+// 预分配的节点池：构造时一次性分配capacity个节点，节点之间用32位下标组成双向链表
+// 下标[0, listNum)为各链表的哨兵节点，之后为数据节点；空闲节点通过next串成空闲链表
+// 命中、淘汰时只修改下标，不涉及内存分配和原子引用计数
+template<typename Key, typename Value>
+class LruSlab{
+public:
+    using NodeType = LruNode<Key, Value>;
+    static const uint32_t npos = UINT32_MAX;
+
+    explicit LruSlab(size_t capacity, size_t listNum = 1);
+
+    uint32_t allocate(const Key& key, const Value& value, size_t hash = 0); // 从空闲链表取出节点，池满时返回npos
+    void release(uint32_t index);                          // 归还节点到空闲链表，同时释放value持有的资源
+    void grow(size_t capacity);                            // 数据节点增加到capacity个，已有节点的下标不变
+
+    void pushBack(size_t list, uint32_t index);            // 插入到链表尾部
+    void pushFront(size_t list, uint32_t index);           // 插入到链表头部
+    void insertBefore(uint32_t pos, uint32_t index);       // 插入到pos节点之前
+    void unlink(uint32_t index);                           // 从所在链表中摘除
+    void moveToBack(size_t list, uint32_t index);          // 移动到链表尾部
+
+    uint32_t front(size_t list) const;                     // 链表第一个节点，链表为空时返回npos
+    uint32_t back(size_t list) const;                      // 链表最后一个节点，链表为空时返回npos
+    uint32_t next(uint32_t index) const;                   // 后继节点，到达链表尾部时返回npos
+    uint32_t prev(uint32_t index) const;                   // 前驱节点，到达链表头部时返回npos
+    bool empty(size_t list) const;
+    bool allocated(uint32_t index) const { return nodes_[index].prev != npos; } // 数据节点是否已分配（空闲节点的prev为npos）
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return used_; }
+    uint32_t dataBegin() const { return static_cast<uint32_t>(listNum_); }   // 数据节点的下标范围[dataBegin, dataEnd)
+    uint32_t dataEnd() const { return static_cast<uint32_t>(nodes_.size()); }
+
+    NodeType& operator[](uint32_t index) { return nodes_[index]; }
+    const NodeType& operator[](uint32_t index) const { return nodes_[index]; }
+
+private:
+    bool isSentinel(uint32_t index) const { return index < listNum_; }
+
+private:
+    std::vector<NodeType> nodes_;
+    size_t listNum_;     // 链表（哨兵）个数
+    size_t capacity_;    // 数据节点个数
+    size_t used_;        // 已分配的数据节点个数
+    uint32_t freeHead_;  // 空闲链表头
+};
+
+template<typename Key, typename Value>
+const uint32_t LruSlab<Key, Value>::npos;
+
+template<typename Key, typename Value>
+LruSlab<Key, Value>::LruSlab(size_t capacity, size_t listNum)
+: nodes_(listNum + capacity)
+, listNum_(listNum)
+, capacity_(capacity)
+, used_(0)
+, freeHead_(npos)
+{
+    for(size_t i = 0; i < listNum_; i++){
+        nodes_[i].prev = static_cast<uint32_t>(i);
+        nodes_[i].next = static_cast<uint32_t>(i);
+    }
+    // 倒序串起空闲链表，使低下标先被分配
+    for(size_t i = nodes_.size(); i > listNum_; i--){
+        nodes_[i - 1].prev = npos;
+        nodes_[i - 1].next = freeHead_;
+        freeHead_ = static_cast<uint32_t>(i - 1);
+    }
+}
+
+template<typename Key, typename Value>
+uint32_t LruSlab<Key, Value>::allocate(const Key& key, const Value& value, size_t hash){
+    if(freeHead_ == npos) return npos;
+    uint32_t index = freeHead_;
+    NodeType& node = nodes_[index];
+    freeHead_ = node.next;
+    node.key = key;
+    node.value = value;
+    node.hash = hash;
+    node.prev = index;
+    node.next = index;
+    ++used_;
+    return index;
+}
+
+template<typename Key, typename Value>
+void LruSlab<Key, Value>::release(uint32_t index){
+    NodeType& node = nodes_[index];
+    node.value = Value();
+    node.prev = npos;
+    node.next = freeHead_;
+    freeHead_ = index;
+    --used_;
+}
+
+template<typename Key, typename Value>
+void LruSlab<Key, Value>::grow(size_t capacity){
+    if(capacity <= capacity_) return;
+    size_t oldSize = nodes_.size();
+    nodes_.resize(listNum_ + capacity);
+    // 新节点倒序压入空闲链表，使低下标先被分配
+    for(size_t i = nodes_.size(); i > oldSize; i--){
+        nodes_[i - 1].prev = npos;
+        nodes_[i - 1].next = freeHead_;
+        freeHead_ = static_cast<uint32_t>(i - 1);
+    }
+    capacity_ = capacity;
+}
+
+template<typename Key, typename Value>
+void LruSlab<Key, Value>::pushBack(size_t list, uint32_t index){
+    insertBefore(static_cast<uint32_t>(list), index);
+}
+
+template<typename Key, typename Value>
+void LruSlab<Key, Value>::pushFront(size_t list, uint32_t index){
+    uint32_t head = static_cast<uint32_t>(list);
+    uint32_t first = nodes_[head].next;
+    nodes_[index].prev = head;
+    nodes_[index].next = first;
+    nodes_[first].prev = index;
+    nodes_[head].next = index;
+}
+
+template<typename Key, typename Value>
+void LruSlab<Key, Value>::insertBefore(uint32_t pos, uint32_t index){
+    uint32_t last = nodes_[pos].prev;
+    nodes_[index].prev = last;
+    nodes_[index].next = pos;
+    nodes_[last].next = index;
+    nodes_[pos].prev = index;
+}
+
+template<typename Key, typename Value>
+void LruSlab<Key, Value>::unlink(uint32_t index){
+    NodeType& node = nodes_[index];
+    nodes_[node.prev].next = node.next;
+    nodes_[node.next].prev = node.prev;
+    node.prev = index;
+    node.next = index;
+}
+
+template<typename Key, typename Value>
+void LruSlab<Key, Value>::moveToBack(size_t list, uint32_t index){
+    unlink(index);
+    pushBack(list, index);
+}
+
+template<typename Key, typename Value>
+uint32_t LruSlab<Key, Value>::front(size_t list) const{
+    uint32_t first = nodes_[list].next;
+    return isSentinel(first) ? npos : first;
+}
+
+template<typename Key, typename Value>
+uint32_t LruSlab<Key, Value>::back(size_t list) const{
+    uint32_t last = nodes_[list].prev;
+    return isSentinel(last) ? npos : last;
+}
+
+template<typename Key, typename Value>
+uint32_t LruSlab<Key, Value>::next(uint32_t index) const{
+    uint32_t nextIndex = nodes_[index].next;
+    return isSentinel(nextIndex) ? npos : nextIndex;
+}
+
+template<typename Key, typename Value>
+uint32_t LruSlab<Key, Value>::prev(uint32_t index) const{
+    uint32_t prevIndex = nodes_[index].prev;
+    return isSentinel(prevIndex) ? npos : prevIndex;
+}
+
+template<typename Key, typename Value>
+bool LruSlab<Key, Value>::empty(size_t list) const{
+    return nodes_[list].next == static_cast<uint32_t>(list);
+}
+
+// LruSlab节点的第二组前驱/后继下标，使同一个节点可以同时位于LruSlab的一条链表和这里的一条链表中
+// 只保存链接不保存数据；下标与LruSlab一致，各链表的哨兵排在所有节点下标之后
+class SlabLinks{
+public:
+    static const uint32_t npos = UINT32_MAX;
+
+    // slotCount：LruSlab的下标总数（哨兵个数 + 容量）
+    SlabLinks(size_t slotCount, size_t listNum)
+    : links_(slotCount + listNum)
+    , base_(static_cast<uint32_t>(slotCount))
+    {
+        for(uint32_t i = 0; i < links_.size(); i++){
+            links_[i].prev = i;
+            links_[i].next = i;
+        }
+    }
+
+    void pushBack(size_t list, uint32_t index){
+        uint32_t head = base_ + static_cast<uint32_t>(list);
+        uint32_t last = links_[head].prev;
+        links_[index].prev = last;
+        links_[index].next = head;
+        links_[last].next = index;
+        links_[head].prev = index;
+    }
+
+    void unlink(uint32_t index){
+        Link& link = links_[index];
+        links_[link.prev].next = link.next;
+        links_[link.next].prev = link.prev;
+        link.prev = index;
+        link.next = index;
+    }
+
+    void moveToBack(size_t list, uint32_t index){
+        unlink(index);
+        pushBack(list, index);
+    }
+
+    // 链表第一个节点，链表为空时返回npos
+    uint32_t front(size_t list) const{
+        uint32_t first = links_[base_ + list].next;
+        return first >= base_ ? npos : first;
+    }
+
+private:
+    struct Link{
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    std::vector<Link> links_;
+    uint32_t base_;   // 第一个哨兵的下标
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ArcGhostList.h"
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "SharedSpinLock.h"
+
+// S3-FIFO：小FIFO（容量10%）过滤只访问一次的key，主FIFO（容量90%）保存被再次访问过的key，
+// 幽灵FIFO记录从小FIFO淘汰的key的指纹，再次出现时直接进入主FIFO
+// 每个节点有2位访问计数，命中只对计数做原子加一，不移动任何链表，所以get只需要共享锁
+// 淘汰时检查计数：小FIFO中访问过的节点晋升到主FIFO，主FIFO中访问过的节点计数减一后重新插回队尾
+template<typename Key, typename Value, typename Index = SwissIndex>
+class S3FifoCache : public cachePolicy<Key, Value>
+{
+public:
+    using NodeMap = typename Index::template Map<Key, uint32_t>;  // key到节点下标的映射
+
+    explicit S3FifoCache(size_t capacity)
+    : capacity_(capacity)
+    , smallCapacity_(capacity / 10 > 0 ? capacity / 10 : 1)
+    , mainCapacity_(capacity > smallCapacity_ ? capacity - smallCapacity_ : 1)
+    , nodes_(capacity)
+    , nodeMap_(capacity)
+    , small_(capacity)
+    , main_(capacity)
+    , ghost_(mainCapacity_)
+    {
+        // 倒序压入，使低下标先被分配
+        freeNodes_.reserve(capacity);
+        for(size_t i = capacity; i > 0; i--){
+            freeNodes_.push_back(static_cast<uint32_t>(i - 1));
+        }
+    }
+
+    ~S3FifoCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+
+private:
+    struct Node{
+        Key key;
+        Value value;
+        std::atomic<uint8_t> freq;   // 0~3，命中时在共享锁下原子递增
+
+        Node() : key(), value(), freq(0) {}
+    };
+
+    // 定长环形队列，保存节点下标，队头最旧
+    struct Fifo{
+        std::vector<uint32_t> ring;
+        size_t head;
+        size_t count;
+
+        explicit Fifo(size_t capacity) : ring(capacity > 0 ? capacity : 1), head(0), count(0) {}
+        void push(uint32_t node) { ring[(head + count) % ring.size()] = node; ++count; }
+        uint32_t pop() { uint32_t node = ring[head]; head = (head + 1) % ring.size(); --count; return node; }
+        size_t size() const { return count; }
+    };
+
+    static const uint8_t kMaxFreq = 3;
+
+    static void touch(Node& node);                // 访问计数加一，饱和于kMaxFreq
+    void evict();                                 // 淘汰一个节点
+    void evictSmall();                            // 从小FIFO淘汰，访问过的节点晋升到主FIFO
+    void evictMain();                             // 从主FIFO淘汰，访问过的节点计数减一后插回队尾
+    void removeNode(uint32_t node);               // 删除节点并归还到空闲栈
+
+private:
+    size_t capacity_;
+    size_t smallCapacity_;                        // 小FIFO容量
+    size_t mainCapacity_;                         // 主FIFO容量，也是幽灵FIFO的容量
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeNodes_;             // 空闲节点下标
+    NodeMap nodeMap_;
+    Fifo small_;
+    Fifo main_;
+    ArcGhostList ghost_;
+    SharedSpinLock lock_;                         // get加共享锁，put和淘汰加独占锁
+};
+
+template<typename Key, typename Value, typename Index>
+void S3FifoCache<Key, Value, Index>::put(Key key, Value value)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<SharedSpinLock> lock(lock_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found != nullptr){
+        nodes_[*found].value = value;
+        touch(nodes_[*found]);
+        return;
+    }
+    while(nodeMap_.size() >= capacity_){
+        evict();
+    }
+    uint32_t node = freeNodes_.back();
+    freeNodes_.pop_back();
+    nodes_[node].key = key;
+    nodes_[node].value = value;
+    nodes_[node].freq.store(0, std::memory_order_relaxed);
+    nodeMap_.insert(key, node);
+    // 幽灵命中说明不久前刚被淘汰过，直接进入主FIFO
+    if(ghost_.erase(ArcGhostList::fingerprint(key))){
+        main_.push(node);
+    }else{
+        small_.push(node);
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+bool S3FifoCache<Key, Value, Index>::get(Key key, Value& value)
+{
+    SharedLockGuard<SharedSpinLock> lock(lock_);
+    const NodeMap& nodeMap = nodeMap_;
+    const uint32_t* found = nodeMap.find(key);
+    if(found == nullptr) return false;
+    Node& node = nodes_[*found];
+    touch(node);
+    value = node.value;
+    return true;
+}
+
+template<typename Key, typename Value, typename Index>
+Value S3FifoCache<Key, Value, Index>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index>
+void S3FifoCache<Key, Value, Index>::touch(Node& node)
+{
+    uint8_t freq = node.freq.load(std::memory_order_relaxed);
+    while(freq < kMaxFreq
+        && !node.freq.compare_exchange_weak(freq, static_cast<uint8_t>(freq + 1), std::memory_order_relaxed)){
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void S3FifoCache<Key, Value, Index>::evict()
+{
+    if(small_.size() >= smallCapacity_ || main_.size() == 0){
+        evictSmall();
+    }else{
+        evictMain();
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void S3FifoCache<Key, Value, Index>::evictSmall()
+{
+    while(small_.size() > 0){
+        uint32_t node = small_.pop();
+        if(nodes_[node].freq.load(std::memory_order_relaxed) > 1){
+            // 在小FIFO中被多次访问，晋升到主FIFO并重新计数
+            nodes_[node].freq.store(0, std::memory_order_relaxed);
+            if(main_.size() >= mainCapacity_){
+                evictMain();
+            }
+            main_.push(node);
+        }else{
+            ghost_.add(ArcGhostList::fingerprint(nodes_[node].key));
+            removeNode(node);
+            return;
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void S3FifoCache<Key, Value, Index>::evictMain()
+{
+    while(main_.size() > 0){
+        uint32_t node = main_.pop();
+        uint8_t freq = nodes_[node].freq.load(std::memory_order_relaxed);
+        if(freq > 0){
+            nodes_[node].freq.store(static_cast<uint8_t>(freq - 1), std::memory_order_relaxed);
+            main_.push(node);
+        }else{
+            removeNode(node);
+            return;
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void S3FifoCache<Key, Value, Index>::removeNode(uint32_t node)
+{
+    nodeMap_.erase(nodes_[node].key);
+    nodes_[node].value = Value();
+    freeNodes_.push_back(node);
+}
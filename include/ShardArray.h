@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+const size_t kCacheLineSize = 64;
+
+// 分片容器：所有分片放在一块连续内存中，每个分片按Align对齐并填充到Align的整数倍，
+// 相邻分片的锁和链表、哈希表头等可变字段不会落在同一个缓存行上，不同线程操作不同分片时互不干扰
+// 分片包装类只读的配置（分片数、掩码、本容器的起始地址）与分片本身分开存放，查找分片时不会读到其他线程正在写的缓存行
+// 构造时一次分配全部空间，随后用emplace_back依次就地构造分片，分片个数之后不再改变
+// C++11的new不保证超过16字节的对齐，这里多申请Align - 1字节自己对齐
+template<typename T, size_t Align = kCacheLineSize>
+class ShardArray
+{
+public:
+    explicit ShardArray(size_t count);
+    ~ShardArray();
+
+    ShardArray(const ShardArray&) = delete;
+    ShardArray& operator=(const ShardArray&) = delete;
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args);  // 在下一个位置就地构造分片
+
+    T& operator[](size_t index) { return slots_[index].shard; }
+    const T& operator[](size_t index) const { return slots_[index].shard; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    // alignas使sizeof(Slot)向上取整为Align的整数倍，数组中每个分片独占若干完整的缓存行
+    struct alignas(Align) Slot{
+        template<typename... Args>
+        explicit Slot(Args&&... args) : shard(std::forward<Args>(args)...) {}
+        T shard;
+    };
+
+private:
+    void* raw_;       // operator new返回的原始地址，释放时使用
+    Slot* slots_;     // 对齐后的起始地址
+    size_t size_;     // 已构造的分片数
+    size_t capacity_;
+};
+
+template<typename T, size_t Align>
+ShardArray<T, Align>::ShardArray(size_t count)
+: raw_(::operator new(count * sizeof(Slot) + Align - 1))
+, slots_(reinterpret_cast<Slot*>((reinterpret_cast<uintptr_t>(raw_) + Align - 1) & ~static_cast<uintptr_t>(Align - 1)))
+, size_(0)
+, capacity_(count)
+{}
+
+template<typename T, size_t Align>
+ShardArray<T, Align>::~ShardArray()
+{
+    for(size_t i = size_; i > 0; i--){
+        slots_[i - 1].~Slot();
+    }
+    ::operator delete(raw_);
+}
+
+template<typename T, size_t Align>
+template<typename... Args>
+T& ShardArray<T, Align>::emplace_back(Args&&... args)
+{
+    Slot* slot = new (&slots_[size_]) Slot(std::forward<Args>(args)...);
+    ++size_;
+    return slot->shard;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// 读写自旋锁：读操作之间不互斥，只有写操作独占
+// C++11没有std::shared_mutex，命中路径只做原子操作的缓存用它让读并发执行
+// 写者到来时先置等待位，新的读者不再进入，避免读多写少时写者饿死
+class SharedSpinLock
+{
+public:
+    SharedSpinLock() : state_(0) {}
+    SharedSpinLock(const SharedSpinLock&) = delete;
+    SharedSpinLock& operator=(const SharedSpinLock&) = delete;
+
+    void lock();            // 独占加锁，可配合std::lock_guard使用
+    void unlock();
+    bool try_lock();        // 没有读者和写者时独占加锁，否则立即返回false
+    void lock_shared();     // 共享加锁
+    void unlock_shared();
+
+    static void cpuRelax(); // 自旋等待时提示CPU让出流水线资源
+
+private:
+    static const uint32_t kWriter = 1u << 31;   // 写者持有
+    static const uint32_t kWaiting = 1u << 30;  // 有写者在等待
+    static const int kSpinLimit = 64;           // 连续自旋这么多次后让出时间片
+
+    std::atomic<uint32_t> state_;               // 低30位为读者个数
+};
+
+// 共享锁的RAII封装，对应std::lock_guard
+template<typename SharedLock>
+class SharedLockGuard
+{
+public:
+    explicit SharedLockGuard(SharedLock& lock) : lock_(lock) { lock_.lock_shared(); }
+    ~SharedLockGuard() { lock_.unlock_shared(); }
+    SharedLockGuard(const SharedLockGuard&) = delete;
+    SharedLockGuard& operator=(const SharedLockGuard&) = delete;
+
+private:
+    SharedLock& lock_;
+};
+
+inline void SharedSpinLock::cpuRelax()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+inline void SharedSpinLock::lock()
+{
+    int spins = 0;
+    for(;;){
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        // 没有读者也没有写者时才能获取，获取后清掉等待位；其他等待的写者会重新置位
+        if((state & ~kWaiting) == 0){
+            if(state_.compare_exchange_weak(state, kWriter, std::memory_order_acquire, std::memory_order_relaxed)) return;
+            continue;
+        }
+        if((state & kWaiting) == 0){
+            state_.fetch_or(kWaiting, std::memory_order_relaxed);
+        }
+        if(++spins < kSpinLimit){
+            cpuRelax();
+        }else{
+            spins = 0;
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline void SharedSpinLock::unlock()
+{
+    state_.fetch_and(~kWriter, std::memory_order_release);
+}
+
+inline bool SharedSpinLock::try_lock()
+{
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    if((state & ~kWaiting) != 0) return false;
+    return state_.compare_exchange_strong(state, kWriter, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline void SharedSpinLock::lock_shared()
+{
+    int spins = 0;
+    for(;;){
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        if((state & (kWriter | kWaiting)) == 0){
+            if(state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) return;
+            continue;
+        }
+        if(++spins < kSpinLimit){
+            cpuRelax();
+        }else{
+            spins = 0;
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline void SharedSpinLock::unlock_shared()
+{
+    state_.fetch_sub(1, std::memory_order_release);
+}
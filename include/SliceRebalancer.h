@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ShardArray.h"
+
+// 分片缓存的容量再平衡：总容量不变，按各分片的未命中数把容量预算从冷分片挪到热分片
+// 哈希均匀时各分片的key数相近，但热点key集中的分片会频繁淘汰，而冷分片的容量长期闲置
+//   统计：每个分片一组访问/未命中计数，按缓存行隔开，分片包装类在get之后记录
+//   触发：某个分片的访问数达到一个统计周期时，由该线程尝试再平衡；已有线程在做时直接跳过
+//   调整：按未命中数排序，未命中最少的一半向最多的一半逐对转移一小步容量，之后清零计数
+//         接收方必须已经装满（未装满说明未命中不是容量不足造成的）；捐出方未装满时空闲的容量直接转移，
+//         否则要求接收方的未命中数明显多于捐出方，避免分布均匀时来回抖动；每个分片保留不低于初始值1/4的容量
+// 容量通过分片的setCapacity调整，容量减小时超出的条目由分片在之后的插入中逐步淘汰
+class SliceRebalancer
+{
+public:
+    SliceRebalancer(size_t sliceNum, size_t sliceCapacity);
+
+    // 记录一次访问，返回true表示该分片到达统计周期，调用者应当在不持有分片锁时调用rebalance
+    bool record(size_t slice, bool hit);
+
+    // sizeOf(i)返回分片i当前的条目数，setCapacity(i, c)设置分片i的容量；同一时刻只有一个线程执行，其余直接返回
+    template<typename SizeFn, typename SetFn>
+    void rebalance(SizeFn sizeOf, SetFn setCapacity);
+
+    // 总容量改变后重新平均分配：各分片的预算都设为sliceCapacity并调用setCapacity(i, sliceCapacity)，计数清零
+    template<typename SetFn>
+    void reset(size_t sliceCapacity, SetFn setCapacity);
+
+    size_t budget(size_t slice);   // 分片当前的容量预算
+
+private:
+    struct Counter{
+        Counter() : accesses(0), misses(0) {}
+        std::atomic<uint32_t> accesses;
+        std::atomic<uint32_t> misses;
+    };
+
+    static const uint32_t kMinEpoch = 1024;   // 统计周期的最小访问数，太短时未命中数的随机波动会引起误调
+    static const uint32_t kMinMisses = 8;    // 接收方未命中数超过捐出方2倍再加上该值才转移已用的容量
+
+private:
+    uint32_t epoch_;                 // 单个分片的统计周期（访问数）
+    size_t step_;                    // 每对分片每次转移的容量
+    size_t minBudget_;               // 单个分片的最小容量
+    ShardArray<Counter> counters_;
+    std::vector<size_t> budgets_;    // 各分片的容量预算，总和不变，由mutex_保护
+    std::vector<uint32_t> misses_;   // 本周期各分片未命中数的快照，由mutex_保护
+    std::vector<size_t> order_;      // 按未命中数排序的分片下标，由mutex_保护
+    std::mutex mutex_;
+};
+
+inline SliceRebalancer::SliceRebalancer(size_t sliceNum, size_t sliceCapacity)
+: epoch_(static_cast<uint32_t>(sliceCapacity * 4 > kMinEpoch ? sliceCapacity * 4 : kMinEpoch))
+, step_(std::max<size_t>(1, sliceCapacity / 8))
+, minBudget_(std::max<size_t>(1, sliceCapacity / 4))
+, counters_(sliceNum)
+, budgets_(sliceNum, sliceCapacity)
+, misses_(sliceNum)
+, order_(sliceNum)
+{
+    for(size_t i = 0; i < sliceNum; i++){
+        counters_.emplace_back();
+    }
+}
+
+inline bool SliceRebalancer::record(size_t slice, bool hit)
+{
+    Counter& counter = counters_[slice];
+    if(!hit) counter.misses.fetch_add(1, std::memory_order_relaxed);
+    // 只在恰好到达周期时返回true，再平衡失败或被跳过时计数继续累加，等下一次清零
+    return counter.accesses.fetch_add(1, std::memory_order_relaxed) + 1 == epoch_;
+}
+
+inline size_t SliceRebalancer::budget(size_t slice)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budgets_[slice];
+}
+
+template<typename SetFn>
+void SliceRebalancer::reset(size_t sliceCapacity, SetFn setCapacity)
+{
+    // 阻塞等待正在进行的再平衡结束，之后它按旧预算设置的容量会被这里覆盖
+    std::lock_guard<std::mutex> lock(mutex_);
+    step_ = std::max<size_t>(1, sliceCapacity / 8);
+    minBudget_ = std::max<size_t>(1, sliceCapacity / 4);
+    for(size_t i = 0; i < budgets_.size(); i++){
+        budgets_[i] = sliceCapacity;
+        setCapacity(i, sliceCapacity);
+        counters_[i].accesses.store(0, std::memory_order_relaxed);
+        counters_[i].misses.store(0, std::memory_order_relaxed);
+    }
+}
+
+template<typename SizeFn, typename SetFn>
+void SliceRebalancer::rebalance(SizeFn sizeOf, SetFn setCapacity)
+{
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if(!lock.owns_lock()) return;
+
+    size_t sliceNum = budgets_.size();
+    for(size_t i = 0; i < sliceNum; i++){
+        misses_[i] = counters_[i].misses.load(std::memory_order_relaxed);
+        order_[i] = i;
+    }
+    std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b){ return misses_[a] < misses_[b]; });
+
+    // 未命中最少的与最多的配对，依次向中间靠拢
+    for(size_t k = 0; k < sliceNum / 2; k++){
+        size_t donor = order_[k];
+        size_t receiver = order_[sliceNum - 1 - k];
+        if(misses_[receiver] == 0) break;
+        if(sizeOf(receiver) < budgets_[receiver]) continue;
+        if(budgets_[donor] < minBudget_ + step_) continue;
+        bool spare = sizeOf(donor) + step_ <= budgets_[donor];
+        if(!spare && misses_[receiver] <= 2 * misses_[donor] + kMinMisses) continue;
+
+        budgets_[donor] -= step_;
+        budgets_[receiver] += step_;
+        // 先缩小再扩大，任何时刻各分片容量之和不超过总容量
+        setCapacity(donor, budgets_[donor]);
+        setCapacity(receiver, budgets_[receiver]);
+    }
+
+    for(size_t i = 0; i < sliceNum; i++){
+        counters_[i].accesses.store(0, std::memory_order_relaxed);
+        counters_[i].misses.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "CacheHash.h"
+#include "ShardArray.h"
+
+// 可在线改变分片数的分片表，供HashLruCache、ArcHashCache保存分片
+// 扩展哈希：分片数为2的幂，key按shardOf(hash, 掩码)选分片；分片数翻倍时分片i一分为二，一半的key留在i，
+// 另一半移到i + n，减半时反过来合并，只有分片下标改变的key需要移动
+//   存储：分片分块存放，第0块为初始的base个分片，第k块为base << (k - 1)个分片；块只增不减，已有分片的地址不变，
+//         留在原下标的key不用移动；缩减后多出的分片容量降为0，对象保留到析构，再次扩大时复用
+//   路由：当前掩码、迁移来源的掩码和版本号打包在一个原子变量中，每次操作只读一次
+//   迁移：reshard只准备好分片、发布新路由后立即返回，之后
+//         get在目标分片未命中时到来源分片查找，找到则移到目标分片；put写入目标分片后删除来源分片中的旧值；
+//         移动条目时先写入目标分片、再在value未改变时删除来源分片中的副本，条目任何时刻至少在一个分片中，
+//         get在来源分片中查不到时再查一次目标分片，不会把迁移中的条目误报为未命中；
+//         迁移期间同一个key的移动和写入按哈希分条的移动锁串行，移动者读到的旧值不会在put写入新值之后才放进目标分片；
+//         每个线程每kMigrateInterval次操作顺带迁移一次，其余操作不碰controlMutex_；每次移动kMigrateBatch个条目，
+//         或从来源分片中接着上次的位置扫描kScanBatch个节点位置、收集下标会改变的key，分片锁的持有时间有上限，
+//         任何时刻只锁住一个分片，其余分片的读写不受影响
+//   并发：put/get写入条目后再读一次路由，期间路由改变（读到的是旧路由）时按新路由把条目再移动一次，
+//         迁移开始后不会有条目留在旧的位置上；put按新路由重新写入自己的value，旧路由下写进已退役（容量降为0）
+//         分片而被丢弃的写入不会丢失；get未命中且期间路由改变时按新路由重查
+// Slice需要提供get/put/take/peek/eraseIfEqual/putIfAbsent/collectKeys/setCapacity/size，见LruCache、ArcCache；Value需支持==
+template<typename Key, typename Value, typename Slice>
+class SliceTable
+{
+public:
+    // 分片数向上取整为2的幂，每个分片的容量为capacity / 分片数向上取整；
+    // makeSlices(chunk, count, sliceCapacity)在chunk中依次构造count个分片
+    template<typename MakeFn>
+    SliceTable(size_t capacity, size_t sliceNum, MakeFn makeSlices);
+    ~SliceTable();
+
+    SliceTable(const SliceTable&) = delete;
+    SliceTable& operator=(const SliceTable&) = delete;
+
+    bool get(const Key& key, Value& value, size_t hash);
+    void put(const Key& key, const Value& value, size_t hash);
+
+    // 改变分片数，条目之后逐步迁移；上一次迁移尚未完成时返回false
+    template<typename MakeFn>
+    bool reshard(size_t sliceNum, MakeFn makeSlices);
+    void resize(size_t capacity);            // 改变总容量，各分片的容量平均分配，减小时由分片逐步淘汰
+
+    size_t sliceNum() const { return maskOf(route_.load(std::memory_order_acquire)) + 1; }
+    size_t sliceCapacity();                  // 当前每个分片的容量
+    size_t indexOf(size_t hash) const { return shardOf(hash, maskOf(route_.load(std::memory_order_acquire))); }
+    bool migrating() const { return isMigrating(route_.load(std::memory_order_acquire)); }
+
+    Slice& operator[](size_t index);
+
+private:
+    static const size_t kMaxChunks = 24;
+    static const size_t kMigrateInterval = 16; // 每个线程每隔多少次操作尝试迁移一次，须为2的幂
+    static const size_t kMigrateBatch = 8;   // 每次迁移移动的条目数
+    static const size_t kScanBatch = 64;     // 每次在来源分片中扫描的节点位置数
+    static const size_t kMoveLocks = 64;     // 移动锁的条数，须为2的幂
+    static const uint64_t kMaskBits = 24;    // 掩码的位数，分片数不超过2^24
+    static const uint64_t kMaskLimit = (1ULL << kMaskBits) - 1;
+
+    // 路由：低24位为来源掩码，之后24位为目标掩码，高16位为版本号，避免同一操作期间路由变回原值时误判未改变
+    static uint64_t makeRoute(size_t mask, size_t oldMask, uint64_t version) {
+        return (version << (kMaskBits * 2)) | (static_cast<uint64_t>(mask) << kMaskBits) | oldMask;
+    }
+    static size_t maskOf(uint64_t route) { return static_cast<size_t>((route >> kMaskBits) & kMaskLimit); }
+    static size_t oldMaskOf(uint64_t route) { return static_cast<size_t>(route & kMaskLimit); }
+    static uint64_t versionOf(uint64_t route) { return route >> (kMaskBits * 2); }
+    static bool isMigrating(uint64_t route) { return maskOf(route) != oldMaskOf(route); }
+
+    size_t sliceCapacityOf(size_t sliceNum) const { return (capacity_ + sliceNum - 1) / sliceNum; }
+    // 路由已改变时把条目移到新的目标分片；written不为空时（put）按新路由重新写入该value
+    void settle(const Key& key, size_t hash, uint64_t route, size_t placed, const Value* written);
+    // 把条目从from移到to：先写入to（已存在时不覆盖，value取回to中的值），再在value未改变时删除from中的副本；
+    // from中不存在或没能放进to时返回false
+    // 需持有moveLockOf(hash)
+    bool moveEntry(const Key& key, size_t hash, size_t from, size_t to, Value& value);
+    std::mutex& moveLockOf(size_t hash) { return moveLocks_[hash & (kMoveLocks - 1)]; }
+    static bool migrateTurn();               // 本线程这次操作是否轮到顺带迁移
+    void migrateStep();                      // 迁移一小批条目，已有线程在迁移时直接返回
+    void finishMigration(uint64_t route);    // 需持有controlMutex_
+
+private:
+    size_t base_;                            // 第0块的分片数
+    std::atomic<ShardArray<Slice>*> chunks_[kMaxChunks];
+    std::atomic<uint64_t> route_;
+    std::mutex moveLocks_[kMoveLocks];       // 只在迁移期间和路由改变后使用，见moveEntry
+
+    // 以下由controlMutex_保护
+    std::mutex controlMutex_;
+    size_t capacity_;                        // 总容量
+    size_t migrateNext_;                     // 正在收集的来源分片
+    size_t migrateCursor_;                   // 来源分片中下次扫描的起点，由分片的collectKeys解释
+    size_t migrateEnd_;                      // 来源分片的结束下标
+    std::vector<std::pair<Key, size_t>> pending_;  // 最近一批扫描收集到的待迁移key及其哈希
+    size_t pendingPos_;
+};
+
+template<typename Key, typename Value, typename Slice>
+const size_t SliceTable<Key, Value, Slice>::kMaxChunks;
+template<typename Key, typename Value, typename Slice>
+const size_t SliceTable<Key, Value, Slice>::kMigrateInterval;
+template<typename Key, typename Value, typename Slice>
+const size_t SliceTable<Key, Value, Slice>::kMigrateBatch;
+template<typename Key, typename Value, typename Slice>
+const size_t SliceTable<Key, Value, Slice>::kScanBatch;
+template<typename Key, typename Value, typename Slice>
+const size_t SliceTable<Key, Value, Slice>::kMoveLocks;
+template<typename Key, typename Value, typename Slice>
+const uint64_t SliceTable<Key, Value, Slice>::kMaskBits;
+template<typename Key, typename Value, typename Slice>
+const uint64_t SliceTable<Key, Value, Slice>::kMaskLimit;
+
+template<typename Key, typename Value, typename Slice>
+template<typename MakeFn>
+SliceTable<Key, Value, Slice>::SliceTable(size_t capacity, size_t sliceNum, MakeFn makeSlices)
+: base_(roundUpPow2(sliceNum > kMaskLimit ? kMaskLimit : sliceNum))
+, route_(makeRoute(base_ - 1, base_ - 1, 0))
+, capacity_(capacity)
+, migrateNext_(0)
+, migrateCursor_(0)
+, migrateEnd_(0)
+, pendingPos_(0)
+{
+    for(size_t i = 0; i < kMaxChunks; i++){
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    ShardArray<Slice>* chunk = new ShardArray<Slice>(base_);
+    makeSlices(*chunk, base_, sliceCapacityOf(base_));
+    chunks_[0].store(chunk, std::memory_order_release);
+}
+
+template<typename Key, typename Value, typename Slice>
+SliceTable<Key, Value, Slice>::~SliceTable()
+{
+    for(size_t i = 0; i < kMaxChunks; i++){
+        delete chunks_[i].load(std::memory_order_relaxed);
+    }
+}
+
+template<typename Key, typename Value, typename Slice>
+Slice& SliceTable<Key, Value, Slice>::operator[](size_t index)
+{
+    if(index < base_) return (*chunks_[0].load(std::memory_order_acquire))[index];
+    // 第k块覆盖下标[base << (k - 1), base << k)
+    size_t chunk = 1;
+    size_t first = base_;
+    while(index >= first * 2){
+        first *= 2;
+        ++chunk;
+    }
+    return (*chunks_[chunk].load(std::memory_order_acquire))[index - first];
+}
+
+template<typename Key, typename Value, typename Slice>
+bool SliceTable<Key, Value, Slice>::get(const Key& key, Value& value, size_t hash)
+{
+    uint64_t route = route_.load(std::memory_order_seq_cst);
+    bool hit = false;
+    for(;;){
+        size_t to = shardOf(hash, maskOf(route));
+        hit = (*this)[to].get(key, value, hash);
+        if(hit) break;
+        size_t from = shardOf(hash, oldMaskOf(route));
+        if(isMigrating(route) && from != to){
+            // 按访问迁移；持锁后确认路由未变，不按过时的路由移动
+            std::unique_lock<std::mutex> lock(moveLockOf(hash));
+            if(route_.load(std::memory_order_seq_cst) == route){
+                hit = moveEntry(key, hash, from, to, value);
+                lock.unlock();
+                if(hit){
+                    settle(key, hash, route, to, nullptr);
+                    break;
+                }
+                // 来源分片中没有：可能刚被其他线程移到目标分片，移动时先写入目标，此时再查一次一定能看到
+                hit = (*this)[to].get(key, value, hash);
+                if(hit) break;
+            }
+        }
+        // 未命中时确认路由没有改变：读到旧路由的get可能查的是已迁空或已退役的分片
+        uint64_t now = route_.load(std::memory_order_seq_cst);
+        if(now == route) break;
+        route = now;
+    }
+    if(isMigrating(route) && migrateTurn()) migrateStep();
+    return hit;
+}
+
+template<typename Key, typename Value, typename Slice>
+void SliceTable<Key, Value, Slice>::put(const Key& key, const Value& value, size_t hash)
+{
+    uint64_t route = route_.load(std::memory_order_seq_cst);
+    size_t to = shardOf(hash, maskOf(route));
+    if(isMigrating(route)){
+        size_t from = shardOf(hash, oldMaskOf(route));
+        std::lock_guard<std::mutex> lock(moveLockOf(hash));
+        (*this)[to].put(key, value, hash);
+        Value old;
+        if(from != to) (*this)[from].take(key, hash, old);
+    }else{
+        (*this)[to].put(key, value, hash);
+    }
+    settle(key, hash, route, to, &value);
+    if(isMigrating(route) && migrateTurn()) migrateStep();
+}
+
+template<typename Key, typename Value, typename Slice>
+void SliceTable<Key, Value, Slice>::settle(const Key& key, size_t hash, uint64_t route, size_t placed, const Value* written)
+{
+    // 写入分片（释放分片锁）之后再读路由：读到的仍是原路由，说明新路由发布在写入之后，
+    // 之后收集来源分片的key时一定能看到这次写入
+    for(;;){
+        uint64_t now = route_.load(std::memory_order_seq_cst);
+        if(now == route) return;
+        size_t to = shardOf(hash, maskOf(now));
+        std::lock_guard<std::mutex> lock(moveLockOf(hash));
+        if(route_.load(std::memory_order_seq_cst) != now) continue;   // 路由又变了，按最新的路由处理
+        if(written != nullptr){
+            // 写入的分片可能在合并完成时已经退役，容量降为0，写入被丢弃；按新路由重新写入，
+            // 再删除旧位置和新路由来源分片中的副本，与迁移期间的put相同，否则来源分片中更早的值之后会被迁回
+            (*this)[to].put(key, *written, hash);
+            Value old;
+            size_t from = shardOf(hash, oldMaskOf(now));
+            if(from != to) (*this)[from].take(key, hash, old);
+            if(placed != to && placed != from) (*this)[placed].take(key, hash, old);
+        }else if(to != placed){
+            Value moved;
+            moveEntry(key, hash, placed, to, moved);
+        }
+        placed = to;
+        route = now;
+    }
+}
+
+template<typename Key, typename Value, typename Slice>
+bool SliceTable<Key, Value, Slice>::moveEntry(const Key& key, size_t hash, size_t from, size_t to, Value& value)
+{
+    Value moved;
+    if(!(*this)[from].peek(key, hash, moved)) return false;
+    // 目标分片已有该key说明期间有更新的put，以它为准
+    bool found = (*this)[to].putIfAbsent(key, moved, hash);
+    if(found) value = moved;
+    else found = (*this)[to].peek(key, hash, value);
+    // 之后删除来源分片中的副本：它已放进目标分片，或目标分片中有更新的值，或放不进目标分片（容量为0）只能丢弃；
+    // 来源分片中的value已改变说明期间有旧路由下的put，由它自己的settle按新路由重新写入
+    (*this)[from].eraseIfEqual(key, hash, moved);
+    return found;
+}
+
+template<typename Key, typename Value, typename Slice>
+template<typename MakeFn>
+bool SliceTable<Key, Value, Slice>::reshard(size_t sliceNum, MakeFn makeSlices)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    uint64_t route = route_.load(std::memory_order_relaxed);
+    if(isMigrating(route)) return false;
+    size_t oldNum = maskOf(route) + 1;
+    size_t newNum = roundUpPow2(sliceNum > 0 ? sliceNum : 1);
+    size_t maxNum = base_ << (kMaxChunks - 1);
+    if(maxNum > kMaskLimit + 1) maxNum = kMaskLimit + 1;
+    if(newNum > maxNum) newNum = maxNum;
+    if(newNum == oldNum) return true;
+
+    size_t sliceCapacity = sliceCapacityOf(newNum);
+    // 补齐尚未分配的块
+    for(size_t first = base_, chunk = 1; first < newNum; first *= 2, chunk++){
+        if(chunks_[chunk].load(std::memory_order_relaxed) == nullptr){
+            ShardArray<Slice>* slices = new ShardArray<Slice>(first);
+            makeSlices(*slices, first, sliceCapacity);
+            chunks_[chunk].store(slices, std::memory_order_release);
+        }
+    }
+    // 目标分片先调整到新容量；扩大时原有分片还要迁出一半的key，容量保留到迁移完成再减小
+    for(size_t i = (newNum > oldNum ? oldNum : 0); i < newNum; i++){
+        (*this)[i].setCapacity(sliceCapacity);
+    }
+    // 合并时只有高位的分片需要迁出，拆分时每个原有分片都有一部分key要迁出
+    migrateNext_ = newNum < oldNum ? newNum : 0;
+    migrateCursor_ = 0;
+    migrateEnd_ = oldNum;
+    pending_.clear();
+    pendingPos_ = 0;
+    route_.store(makeRoute(newNum - 1, oldNum - 1, versionOf(route) + 1), std::memory_order_seq_cst);
+    return true;
+}
+
+template<typename Key, typename Value, typename Slice>
+void SliceTable<Key, Value, Slice>::resize(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    capacity_ = capacity;
+    // 迁移中的来源分片在迁移完成时按新容量调整：拆分时原有分片还有key要迁出，现在缩小会把它们淘汰掉
+    uint64_t route = route_.load(std::memory_order_relaxed);
+    size_t sliceNum = maskOf(route) + 1;
+    size_t sliceCapacity = sliceCapacityOf(sliceNum);
+    size_t first = maskOf(route) > oldMaskOf(route) ? oldMaskOf(route) + 1 : 0;
+    for(size_t i = first; i < sliceNum; i++){
+        (*this)[i].setCapacity(sliceCapacity);
+    }
+}
+
+template<typename Key, typename Value, typename Slice>
+size_t SliceTable<Key, Value, Slice>::sliceCapacity()
+{
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    return sliceCapacityOf(maskOf(route_.load(std::memory_order_relaxed)) + 1);
+}
+
+template<typename Key, typename Value, typename Slice>
+bool SliceTable<Key, Value, Slice>::migrateTurn()
+{
+    // 按线程计数，不同线程之间没有共享的写
+    static thread_local size_t ops = 0;
+    return (++ops & (kMigrateInterval - 1)) == 0;
+}
+
+template<typename Key, typename Value, typename Slice>
+void SliceTable<Key, Value, Slice>::migrateStep()
+{
+    std::unique_lock<std::mutex> lock(controlMutex_, std::try_to_lock);
+    if(!lock.owns_lock()) return;
+    uint64_t route = route_.load(std::memory_order_relaxed);
+    if(!isMigrating(route)) return;
+    size_t mask = maskOf(route);
+
+    for(size_t moved = 0; moved < kMigrateBatch; moved++){
+        if(pendingPos_ == pending_.size()){
+            if(migrateNext_ == migrateEnd_){
+                finishMigration(route);
+                return;
+            }
+            // 接着上次的位置在来源分片中扫描一批节点，收集下标会改变的key，占用本次的全部配额
+            size_t source = migrateNext_;
+            pending_.clear();
+            pendingPos_ = 0;
+            if((*this)[source].collectKeys([source, mask](size_t hash){ return shardOf(hash, mask) != source; },
+                                           migrateCursor_, kScanBatch, pending_)){
+                ++migrateNext_;
+                migrateCursor_ = 0;
+            }
+            return;
+        }
+        const std::pair<Key, size_t>& entry = pending_[pendingPos_++];
+        std::lock_guard<std::mutex> moveLock(moveLockOf(entry.second));
+        Value value;
+        // 期间被访问迁移、被put删除或被淘汰的key在来源分片中查不到，直接跳过
+        moveEntry(entry.first, entry.second, shardOf(entry.second, oldMaskOf(route)), shardOf(entry.second, mask), value);
+    }
+}
+
+template<typename Key, typename Value, typename Slice>
+void SliceTable<Key, Value, Slice>::finishMigration(uint64_t route)
+{
+    size_t mask = maskOf(route);
+    size_t oldMask = oldMaskOf(route);
+    route_.store(makeRoute(mask, mask, versionOf(route) + 1), std::memory_order_seq_cst);
+    if(mask > oldMask){
+        // 拆分：原有分片迁出了一半的key，容量减到与新分片相同
+        size_t sliceCapacity = sliceCapacityOf(mask + 1);
+        for(size_t i = 0; i <= oldMask; i++){
+            (*this)[i].setCapacity(sliceCapacity);
+        }
+    }else{
+        // 合并：高位分片已经迁空，容量降为0；旧路由下迟到的写入被丢弃，由写入方的settle按新路由重新写入
+        for(size_t i = mask + 1; i <= oldMask; i++){
+            (*this)[i].setCapacity(0);
+        }
+    }
+    std::vector<std::pair<Key, size_t>>().swap(pending_);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
+
+// 分段LRU（SLRU）：新key进入试用段，在试用段再次被访问才晋升到保护段
+// 保护段满时最久未使用的节点降级回试用段的最新位置，淘汰只发生在试用段，一次性扫描无法冲掉保护段
+// 两段共用一个LruSlab节点池和一个key索引，晋升、降级只是在两条链表之间移动下标
+template<typename Key, typename Value, typename Index = SwissIndex>
+class SlruCache : public cachePolicy<Key, Value>
+{
+public:
+    using NodeSlab = LruSlab<Key, Value>;
+    using Nodemap = typename Index::template Map<Key, uint32_t>;  // key到节点下标的映射
+
+    // protectedRatio：保护段占总容量的比例
+    SlruCache(int capacity, double protectedRatio = 0.8)
+    : capacity_(capacity > 0 ? capacity : 0)
+    , protectedCapacity_(static_cast<size_t>(capacity_ * protectedRatio))
+    , protectedSize_(0)
+    , nodeMap_(capacity_)
+    , slab_(capacity_, kListNum)
+    , inProtected_(capacity_ + kListNum, 0)
+    {
+        if(protectedCapacity_ >= capacity_ && capacity_ > 0) protectedCapacity_ = capacity_ - 1;
+    }
+
+    ~SlruCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+    void remove(Key key);
+
+private:
+    void onHit(uint32_t node);           // 命中：试用段晋升，保护段移到最新位置
+    void evictLeastRecent();             // 淘汰试用段最久未使用的节点，试用段为空时淘汰保护段的
+    void removeNode(uint32_t node);
+
+private:
+    static const size_t kProbation = 0;  // 试用段：头部最久未使用，尾部最近使用
+    static const size_t kProtected = 1;  // 保护段
+    static const size_t kListNum = 2;
+
+    size_t capacity_;
+    size_t protectedCapacity_;           // 保护段容量，至少给试用段留一个位置
+    size_t protectedSize_;
+    Nodemap nodeMap_;
+    NodeSlab slab_;
+    std::vector<uint8_t> inProtected_;   // 节点下标 -> 是否在保护段
+    std::mutex mutex_;
+};
+
+template<typename Key, typename Value, typename Index>
+void SlruCache<Key, Value, Index>::put(Key key, Value value)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found != nullptr){
+        slab_[*found].setValue(value);
+        onHit(*found);
+        return;
+    }
+    if(nodeMap_.size() >= capacity_){
+        evictLeastRecent();
+    }
+    uint32_t node = slab_.allocate(key, value);
+    slab_.pushBack(kProbation, node);
+    inProtected_[node] = 0;
+    nodeMap_.insert(key, node);
+}
+
+template<typename Key, typename Value, typename Index>
+bool SlruCache<Key, Value, Index>::get(Key key, Value& value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found == nullptr) return false;
+    onHit(*found);
+    value = slab_[*found].getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index>
+Value SlruCache<Key, Value, Index>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index>
+void SlruCache<Key, Value, Index>::remove(Key key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found != nullptr){
+        removeNode(*found);
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void SlruCache<Key, Value, Index>::onHit(uint32_t node)
+{
+    if(inProtected_[node]){
+        slab_.moveToBack(kProtected, node);
+        return;
+    }
+    // 保护段已满时先把其中最久未使用的节点降级，腾出位置
+    if(protectedSize_ >= protectedCapacity_){
+        uint32_t demoted = slab_.front(kProtected);
+        if(demoted == NodeSlab::npos){
+            // 保护段容量为0，退化为只用试用段的LRU
+            slab_.moveToBack(kProbation, node);
+            return;
+        }
+        slab_.moveToBack(kProbation, demoted);
+        inProtected_[demoted] = 0;
+        --protectedSize_;
+    }
+    slab_.moveToBack(kProtected, node);
+    inProtected_[node] = 1;
+    ++protectedSize_;
+}
+
+template<typename Key, typename Value, typename Index>
+void SlruCache<Key, Value, Index>::evictLeastRecent()
+{
+    uint32_t node = slab_.front(kProbation);
+    if(node == NodeSlab::npos) node = slab_.front(kProtected);
+    if(node == NodeSlab::npos) return;
+    removeNode(node);
+}
+
+template<typename Key, typename Value, typename Index>
+void SlruCache<Key, Value, Index>::removeNode(uint32_t node)
+{
+    if(inProtected_[node]) --protectedSize_;
+    slab_.unlink(node);
+    nodeMap_.erase(slab_[node].getKey());
+    slab_.release(node);
+}
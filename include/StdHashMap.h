@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "CacheHash.h"
+
+// std::unordered_map的包装，接口与FlatHashMap一致，作为StdIndex供缓存策略使用
+// 用作对比基准：每个元素单独分配节点，查找要经过桶数组再跳到节点；带hash参数的重载无法利用已算好的哈希值，仍由表内重新计算
+template<typename Key, typename T, typename Hash = std::hash<Key>>
+class StdHashMap{
+public:
+    explicit StdHashMap(size_t expected = 0)
+    {
+        reserve(expected);
+    }
+
+    T* find(const Key& key);                          // 查找key，不存在时返回nullptr
+    const T* find(const Key& key) const;
+    bool contains(const Key& key) const { return find(key) != nullptr; }
+    T& operator[](const Key& key) { return map_[key]; }
+    bool insert(const Key& key, const T& value);      // 插入或覆盖，返回是否为新插入
+    bool erase(const Key& key) { return map_.erase(key) != 0; }
+
+    size_t hashOf(const Key& key) const { return cacheHashOf(map_.hash_function(), key); }
+    T* find(const Key& key, size_t) { return find(key); }
+    const T* find(const Key& key, size_t) const { return find(key); }
+    bool insert(const Key& key, const T& value, size_t) { return insert(key, value); }
+    bool erase(const Key& key, size_t) { return erase(key); }
+    void clear() { map_.clear(); }
+    void reserve(size_t expected) { map_.reserve(expected); }
+
+    template<typename Func>
+    void forEach(Func func);                          // 遍历所有元素，func(const Key&, T&)
+
+    size_t size() const { return map_.size(); }
+    bool empty() const { return map_.empty(); }
+
+private:
+    std::unordered_map<Key, T, Hash> map_;
+};
+
+template<typename Key, typename T, typename Hash>
+T* StdHashMap<Key, T, Hash>::find(const Key& key){
+    auto it = map_.find(key);
+    return it == map_.end() ? nullptr : &it->second;
+}
+
+template<typename Key, typename T, typename Hash>
+const T* StdHashMap<Key, T, Hash>::find(const Key& key) const{
+    auto it = map_.find(key);
+    return it == map_.end() ? nullptr : &it->second;
+}
+
+template<typename Key, typename T, typename Hash>
+bool StdHashMap<Key, T, Hash>::insert(const Key& key, const T& value){
+    auto result = map_.insert(std::make_pair(key, value));
+    if(!result.second) result.first->second = value;
+    return result.second;
+}
+
+template<typename Key, typename T, typename Hash>
+template<typename Func>
+void StdHashMap<Key, T, Hash>::forEach(Func func){
+    for(auto& item : map_){
+        func(item.first, item.second);
+    }
+}
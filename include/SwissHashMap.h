@@ -0,0 +1,343 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "CacheHash.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CACHE_SWISS_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CACHE_SWISS_NEON 1
+#endif
+
+// 控制字节分组（Swiss table）哈希表，接口与FlatHashMap一致，可作为缓存策略的key索引
+// 每个槽位对应一个控制字节：空槽或哈希值的低7位标签
+// 查找时以16个控制字节为一组，x86使用SSE2、ARM使用NEON一次比较整组标签，其余平台使用标量实现
+// 按组线性探测，删除不留删除标记：组内原有空槽时直接置空，否则按组做后移删除，从后续组中移来一个探测序列经过该组的元素填上，
+// 删除不会触发内存分配；容量按缓存容量预先分配，装载因子超过7/8时才扩容
+namespace SwissDetail{
+
+static const int8_t kEmpty = -128;   // 0b10000000
+static const size_t kGroupWidth = 16;
+
+// 组匹配结果：每个命中的槽位对应一个置位，用lowest()/next()依次取出槽位编号
+class BitMask{
+public:
+#if defined(CACHE_SWISS_NEON)
+    static const int kShift = 2;     // NEON每个槽位占4个bit
+#else
+    static const int kShift = 0;     // SSE2与标量实现每个槽位占1个bit
+#endif
+    explicit BitMask(uint64_t mask):mask_(mask) {}
+    bool any() const { return mask_ != 0; }
+    size_t lowest() const { return static_cast<size_t>(__builtin_ctzll(mask_)) >> kShift; }
+    void next() { mask_ &= mask_ - 1; }
+private:
+    uint64_t mask_;
+};
+
+class Group{
+public:
+    explicit Group(const int8_t* ctrl){
+#if defined(CACHE_SWISS_SSE2)
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif defined(CACHE_SWISS_NEON)
+        ctrl_ = vld1q_s8(ctrl);
+#else
+        for(size_t i = 0; i < kGroupWidth; i++) ctrl_[i] = ctrl[i];
+#endif
+    }
+
+    // 标签等于h2的槽位
+    BitMask match(int8_t h2) const{
+#if defined(CACHE_SWISS_SSE2)
+        return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_))));
+#elif defined(CACHE_SWISS_NEON)
+        return BitMask(toMask(vceqq_s8(vdupq_n_s8(h2), ctrl_)));
+#else
+        uint64_t mask = 0;
+        for(size_t i = 0; i < kGroupWidth; i++){
+            if(ctrl_[i] == h2) mask |= 1ULL << i;
+        }
+        return BitMask(mask);
+#endif
+    }
+
+    // 空槽（控制字节最高位为1）
+    BitMask matchEmpty() const{
+#if defined(CACHE_SWISS_SSE2)
+        return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(ctrl_)));
+#elif defined(CACHE_SWISS_NEON)
+        return BitMask(toMask(vcltq_s8(ctrl_, vdupq_n_s8(0))));
+#else
+        uint64_t mask = 0;
+        for(size_t i = 0; i < kGroupWidth; i++){
+            if(ctrl_[i] < 0) mask |= 1ULL << i;
+        }
+        return BitMask(mask);
+#endif
+    }
+
+private:
+#if defined(CACHE_SWISS_NEON)
+    // 将16字节比较结果压缩为64bit，每个槽位4bit，只保留其中1bit便于逐个取出
+    static uint64_t toMask(uint8x16_t cmp){
+        uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL;
+    }
+#endif
+
+private:
+#if defined(CACHE_SWISS_SSE2)
+    __m128i ctrl_;
+#elif defined(CACHE_SWISS_NEON)
+    int8x16_t ctrl_;
+#else
+    int8_t ctrl_[kGroupWidth];
+#endif
+};
+
+} // namespace SwissDetail
+
+template<typename Key, typename T, typename Hash = std::hash<Key>>
+class SwissHashMap{
+private:
+    struct Slot{
+        Key key;
+        T value;
+        size_t hash;   // 混合后的哈希值，扩容时无需重新计算
+
+        Slot():key(), value(), hash(0) {}
+    };
+
+public:
+    explicit SwissHashMap(size_t expected = 0)
+    : size_(0)
+    , groupMask_(0)
+    {
+        reserve(expected);
+    }
+
+    T* find(const Key& key);                          // 查找key，不存在时返回nullptr
+    const T* find(const Key& key) const;
+    bool contains(const Key& key) const { return find(key) != nullptr; }
+    T& operator[](const Key& key);                    // 不存在时插入默认值
+    bool insert(const Key& key, const T& value);      // 插入或覆盖，返回是否为新插入
+    bool erase(const Key& key);                       // 删除key，返回是否删除成功
+
+    // 表内使用的哈希值；以下重载直接使用调用方已算好的hashOf(key)，不再重复计算
+    size_t hashOf(const Key& key) const { return cacheHashOf(hasher_, key); }
+    T* find(const Key& key, size_t hash);
+    const T* find(const Key& key, size_t hash) const;
+    bool insert(const Key& key, const T& value, size_t hash);
+    bool erase(const Key& key, size_t hash);
+    void clear();
+    void reserve(size_t expected);                    // 保证容纳expected个元素时不扩容
+
+    template<typename Func>
+    void forEach(Func func);                          // 遍历所有元素，func(const Key&, T&)
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    static size_t h1(size_t hash) { return hash >> 7; }
+    static int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    size_t findSlot(const Key& key, size_t hash) const;  // 返回key所在槽位，不存在时返回slots_.size()
+    size_t insertSlot(const Key& key, size_t hash);      // 返回key所在或新插入的槽位
+    size_t findInsertPosition(size_t hash) const;        // 探测序列上的第一个空槽
+    void eraseSlot(size_t index);                        // 按组后移删除
+    void setCtrl(size_t index, int8_t value) { ctrl_[index] = value; }
+    void rehash(size_t groupNum);
+
+private:
+    std::vector<int8_t> ctrl_;   // 控制字节，按16个一组
+    std::vector<Slot> slots_;
+    size_t size_;
+    size_t groupMask_;
+    Hash hasher_;
+};
+
+template<typename Key, typename T, typename Hash>
+T* SwissHashMap<Key, T, Hash>::find(const Key& key){
+    return find(key, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+T* SwissHashMap<Key, T, Hash>::find(const Key& key, size_t hash){
+    size_t index = findSlot(key, hash);
+    return index == slots_.size() ? nullptr : &slots_[index].value;
+}
+
+template<typename Key, typename T, typename Hash>
+const T* SwissHashMap<Key, T, Hash>::find(const Key& key) const{
+    return find(key, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+const T* SwissHashMap<Key, T, Hash>::find(const Key& key, size_t hash) const{
+    size_t index = findSlot(key, hash);
+    return index == slots_.size() ? nullptr : &slots_[index].value;
+}
+
+template<typename Key, typename T, typename Hash>
+T& SwissHashMap<Key, T, Hash>::operator[](const Key& key){
+    return slots_[insertSlot(key, hashOf(key))].value;
+}
+
+template<typename Key, typename T, typename Hash>
+bool SwissHashMap<Key, T, Hash>::insert(const Key& key, const T& value){
+    return insert(key, value, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+bool SwissHashMap<Key, T, Hash>::insert(const Key& key, const T& value, size_t hash){
+    size_t oldSize = size_;
+    slots_[insertSlot(key, hash)].value = value;
+    return size_ != oldSize;
+}
+
+template<typename Key, typename T, typename Hash>
+bool SwissHashMap<Key, T, Hash>::erase(const Key& key){
+    return erase(key, hashOf(key));
+}
+
+template<typename Key, typename T, typename Hash>
+bool SwissHashMap<Key, T, Hash>::erase(const Key& key, size_t hash){
+    size_t index = findSlot(key, hash);
+    if(index == slots_.size()) return false;
+    eraseSlot(index);
+    return true;
+}
+
+template<typename Key, typename T, typename Hash>
+void SwissHashMap<Key, T, Hash>::clear(){
+    for(size_t i = 0; i < slots_.size(); i++){
+        if(ctrl_[i] >= 0) slots_[i] = Slot();
+        ctrl_[i] = SwissDetail::kEmpty;
+    }
+    size_ = 0;
+}
+
+template<typename Key, typename T, typename Hash>
+void SwissHashMap<Key, T, Hash>::reserve(size_t expected){
+    // 最大装载因子7/8
+    size_t groupNum = 1;
+    while(groupNum * SwissDetail::kGroupWidth * 7 < expected * 8) groupNum <<= 1;
+    if(groupNum * SwissDetail::kGroupWidth > slots_.size()){
+        rehash(groupNum);
+    }
+}
+
+template<typename Key, typename T, typename Hash>
+template<typename Func>
+void SwissHashMap<Key, T, Hash>::forEach(Func func){
+    for(size_t i = 0; i < slots_.size(); i++){
+        if(ctrl_[i] >= 0) func(slots_[i].key, slots_[i].value);
+    }
+}
+
+template<typename Key, typename T, typename Hash>
+size_t SwissHashMap<Key, T, Hash>::findSlot(const Key& key, size_t hash) const{
+    int8_t tag = h2(hash);
+    size_t group = h1(hash) & groupMask_;
+    for(size_t probe = 0; probe <= groupMask_; probe++){
+        size_t base = group * SwissDetail::kGroupWidth;
+        SwissDetail::Group g(&ctrl_[base]);
+        for(SwissDetail::BitMask m = g.match(tag); m.any(); m.next()){
+            size_t index = base + m.lowest();
+            if(slots_[index].hash == hash && slots_[index].key == key){
+                return index;
+            }
+        }
+        // 组内存在空槽说明探测序列到此为止
+        if(g.matchEmpty().any()) break;
+        group = (group + 1) & groupMask_;
+    }
+    return slots_.size();
+}
+
+template<typename Key, typename T, typename Hash>
+size_t SwissHashMap<Key, T, Hash>::findInsertPosition(size_t hash) const{
+    size_t group = h1(hash) & groupMask_;
+    while(true){
+        size_t base = group * SwissDetail::kGroupWidth;
+        SwissDetail::BitMask m = SwissDetail::Group(&ctrl_[base]).matchEmpty();
+        if(m.any()) return base + m.lowest();
+        group = (group + 1) & groupMask_;
+    }
+}
+
+template<typename Key, typename T, typename Hash>
+size_t SwissHashMap<Key, T, Hash>::insertSlot(const Key& key, size_t hash){
+    size_t index = findSlot(key, hash);
+    if(index != slots_.size()) return index;
+
+    if((size_ + 1) * 8 > slots_.size() * 7){
+        rehash((groupMask_ + 1) * 2);
+    }
+    index = findInsertPosition(hash);
+    setCtrl(index, h2(hash));
+    slots_[index].key = key;
+    slots_[index].hash = hash;
+    ++size_;
+    return index;
+}
+
+template<typename Key, typename T, typename Hash>
+void SwissHashMap<Key, T, Hash>::eraseSlot(size_t index){
+    slots_[index] = Slot();
+    --size_;
+    size_t hole = index;
+    for(;;){
+        size_t holeGroup = hole / SwissDetail::kGroupWidth;
+        // 组内原有空槽时，没有探测序列越过该组，直接置空
+        if(SwissDetail::Group(&ctrl_[holeGroup * SwissDetail::kGroupWidth]).matchEmpty().any()){
+            setCtrl(hole, SwissDetail::kEmpty);
+            return;
+        }
+        // 组原本是满的，之后直到第一个有空槽的组为止，可能有元素的探测序列经过该组；
+        // 找到一个移进空位，它原来的槽位成为新的空位，否则空位直接置空
+        size_t moved = slots_.size();
+        size_t group = holeGroup;
+        do{
+            group = (group + 1) & groupMask_;
+            size_t base = group * SwissDetail::kGroupWidth;
+            for(size_t i = base; i < base + SwissDetail::kGroupWidth && moved == slots_.size(); i++){
+                if(ctrl_[i] < 0) continue;
+                size_t home = h1(slots_[i].hash) & groupMask_;
+                if(((holeGroup - home) & groupMask_) < ((group - home) & groupMask_)) moved = i;
+            }
+        }while(moved == slots_.size() && !SwissDetail::Group(&ctrl_[group * SwissDetail::kGroupWidth]).matchEmpty().any());
+        if(moved == slots_.size()){
+            setCtrl(hole, SwissDetail::kEmpty);
+            return;
+        }
+        setCtrl(hole, ctrl_[moved]);
+        slots_[hole] = std::move(slots_[moved]);
+        slots_[moved] = Slot();
+        hole = moved;
+    }
+}
+
+template<typename Key, typename T, typename Hash>
+void SwissHashMap<Key, T, Hash>::rehash(size_t groupNum){
+    std::vector<int8_t> oldCtrl(groupNum * SwissDetail::kGroupWidth, SwissDetail::kEmpty);
+    std::vector<Slot> oldSlots(groupNum * SwissDetail::kGroupWidth);
+    oldCtrl.swap(ctrl_);
+    oldSlots.swap(slots_);
+    groupMask_ = groupNum - 1;
+    for(size_t i = 0; i < oldSlots.size(); i++){
+        if(oldCtrl[i] < 0) continue;
+        size_t index = findInsertPosition(oldSlots[i].hash);
+        setCtrl(index, h2(oldSlots[i].hash));
+        slots_[index] = std::move(oldSlots[i]);
+    }
+}
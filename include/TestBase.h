@@ -20,7 +20,7 @@ public:
     void testHotData(const int CAPACITY=50, const int OPERATIONS=200000, const int HOT_KEYS=50, const int COLD_KEYS=500);
     void testLoop(const int CAPACITY=50, const int LOOP_SIZE=200, const int OPERATIONS=200000);
     void testWorkloadShift(const int CAPACITY=50, const int OPERATIONS=200000);
-    void printResult(const std::string& testName, int capacity, int getOps, int hits, std::chrono::duration<double> diffTime);
+    void printResult(const std::string& testName, int capacity, int operations, int getOps, int hits, std::chrono::duration<double> diffTime);
 private:
     Cache& cache_;
     std::string CacheName_;
@@ -57,7 +57,7 @@ void TestBase<Cache>::testHotData(const int CAPACITY, const int OPERATIONS, cons
     auto timeEnd = std::chrono::steady_clock::now();
     std::chrono::duration<double> diffTime = timeEnd-timeStart; // 以秒为单位
 
-    printResult("热点数据访问", CAPACITY, getOps, hits, diffTime);
+    printResult("热点数据访问", CAPACITY, OPERATIONS, getOps, hits, diffTime);
 }
 
 template<typename Cache>
@@ -86,7 +86,7 @@ void TestBase<Cache>::testLoop(const int CAPACITY, const int LOOP_SIZE, const in
     auto timeEnd = std::chrono::steady_clock::now();
     std::chrono::duration<double> diffTime = timeEnd-timeStart; // 以秒为单位
 
-    printResult("循环扫描", CAPACITY, getOps, hits, diffTime);
+    printResult("循环扫描", CAPACITY, OPERATIONS, getOps, hits, diffTime);
 }
 
 template<typename Cache>
@@ -127,17 +127,19 @@ void TestBase<Cache>::testWorkloadShift(const int CAPACITY, const int OPERATIONS
     auto timeEnd = std::chrono::steady_clock::now();
     std::chrono::duration<double> diffTime = timeEnd-timeStart; // 以秒为单位
 
-    printResult("工作负载变化测试", CAPACITY, getOps, hits, diffTime);
+    printResult("工作负载变化测试", CAPACITY, OPERATIONS, getOps, hits, diffTime);
 }
 
 template<typename Cache>
-void TestBase<Cache>::printResult(const std::string& testName, int capacity, int getOps, int hits, std::chrono::duration<double> diffTime)
+void TestBase<Cache>::printResult(const std::string& testName, int capacity, int operations, int getOps, int hits, std::chrono::duration<double> diffTime)
 {
     double hitRate = 100.0 * hits / getOps;
     std::cout << "=== " << testName << " 结果汇总 ===" << std::endl;
     std::cout << "缓存大小: " << capacity << std::endl;
     std::cout << "运行时间：" << std::fixed << std::setprecision(6) 
             << diffTime.count() << "秒" << std::endl;
+    std::cout << "平均耗时: " << std::fixed << std::setprecision(2)
+            << diffTime.count() * 1e9 / operations << "ns/op" << std::endl;
     std::cout << "命中率: " << std::fixed << std::setprecision(2) 
             << hitRate << "% (" << hits << "/" << getOps << ")\n\n";
 }
\ No newline at end of file
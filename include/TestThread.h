@@ -245,6 +245,7 @@ private:
         std::cout << "\n=== " << name << " ===\n";
         std::cout << "线程数: " << nthreads_ << "\n";
         std::cout << "时间: " << std::fixed << std::setprecision(4) << diff << " 秒\n";
+        std::cout << "吞吐量: " << std::fixed << std::setprecision(0) << ops.size() / diff << " ops/s\n";
         std::cout << "命中率: " << std::fixed << std::setprecision(2)
                   << hitRate << "% (" << result.first << "/"
                   << result.second << ")\n";
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "FrequencySketch.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
+
+// W-TinyLFU：新key先进入容量约1%的窗口LRU，从窗口淘汰的候选者要与主缓存的淘汰者比较频次估计，
+// 频次更高的一方留下，只访问一次的key因此无法挤掉热点数据
+// 主缓存为分段LRU：首次进入放在试用段，试用段再次命中晋升到保护段（占主缓存80%），保护段溢出时降级回试用段
+// 三段链表共用一个LruSlab节点池和一个key索引；key的哈希每次操作只算一次，频次估计和key索引共用，节点保存哈希供淘汰时使用
+template<typename Key, typename Value, typename Index = SwissIndex, typename Hash = CacheHash<Key>>
+class TinyLfuCache : public cachePolicy<Key, Value>
+{
+public:
+    using NodeSlab = LruSlab<Key, Value>;
+    using NodeMap = typename Index::template Map<Key, uint32_t, Hash>;  // key到节点下标的映射
+
+    explicit TinyLfuCache(size_t capacity)
+    : capacity_(capacity)
+    , windowCapacity_(capacity == 0 ? 0 : (capacity / 100 > 0 ? capacity / 100 : 1))
+    , protectedCapacity_((capacity - windowCapacity_) * 8 / 10)
+    , nodeMap_(capacity)
+    , slab_(capacity, kListNum)
+    , listOf_(capacity + kListNum, kWindow)
+    , sketch_(capacity)
+    {}
+
+    ~TinyLfuCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+
+    // hash为cacheHashOf(Hash(), key)，由分片包装类算好传入，分片内不再重复计算
+    void put(Key key, Value value, size_t hash);
+    bool get(Key key, Value& value, size_t hash);
+
+private:
+    enum List : uint8_t { kWindow = 0, kProbation = 1, kProtected = 2 };
+    static const size_t kListNum = 3;
+
+    void onHit(uint32_t node);                     // 命中后按所在段调整位置
+    void addNewNode(const Key& key, const Value& value, size_t hash);
+    void evictFromWindow();                        // 窗口溢出时让候选者与主缓存的淘汰者竞争
+    void moveTo(List list, uint32_t node);         // 移动到list的尾部（MRU）
+    void removeNode(uint32_t node);                // 彻底删除节点
+
+private:
+    size_t capacity_;
+    size_t windowCapacity_;       // 窗口LRU容量
+    size_t protectedCapacity_;    // 保护段容量，主缓存其余部分为试用段
+    size_t sizes_[kListNum] = {0, 0, 0};
+    NodeMap nodeMap_;
+    NodeSlab slab_;
+    std::vector<uint8_t> listOf_; // 节点下标 -> 所在段
+    FrequencySketch sketch_;
+    std::mutex mutex_;
+};
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void TinyLfuCache<Key, Value, Index, Hash>::put(Key key, Value value)
+{
+    put(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void TinyLfuCache<Key, Value, Index, Hash>::put(Key key, Value value, size_t hash)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    sketch_.increment(hash);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found != nullptr){
+        slab_[*found].setValue(value);
+        onHit(*found);
+        return;
+    }
+    addNewNode(key, value, hash);
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool TinyLfuCache<Key, Value, Index, Hash>::get(Key key, Value& value)
+{
+    return get(key, value, cacheHashOf(Hash(), key));
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+bool TinyLfuCache<Key, Value, Index, Hash>::get(Key key, Value& value, size_t hash)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 未命中也要记录频次，下次put时才能据此判断是否准入
+    sketch_.increment(hash);
+    uint32_t* found = nodeMap_.find(key, hash);
+    if(found == nullptr) return false;
+    onHit(*found);
+    value = slab_[*found].getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+Value TinyLfuCache<Key, Value, Index, Hash>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void TinyLfuCache<Key, Value, Index, Hash>::onHit(uint32_t node)
+{
+    switch(listOf_[node]){
+        case kWindow:
+            moveTo(kWindow, node);
+            break;
+        case kProbation:
+            // 试用段再次命中，晋升到保护段；保护段溢出时最旧的节点降级回试用段
+            moveTo(kProtected, node);
+            if(sizes_[kProtected] > protectedCapacity_){
+                moveTo(kProbation, slab_.front(kProtected));
+            }
+            break;
+        case kProtected:
+            moveTo(kProtected, node);
+            break;
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void TinyLfuCache<Key, Value, Index, Hash>::addNewNode(const Key& key, const Value& value, size_t hash)
+{
+    // 先腾出一个位置再分配，保证节点池不会溢出
+    if(nodeMap_.size() >= capacity_){
+        if(sizes_[kWindow] > 0){
+            evictFromWindow();
+        }else{
+            uint32_t victim = slab_.front(kProbation);
+            removeNode(victim != NodeSlab::npos ? victim : slab_.front(kProtected));
+        }
+    }
+    uint32_t node = slab_.allocate(key, value, hash);
+    slab_.pushBack(kWindow, node);
+    listOf_[node] = kWindow;
+    ++sizes_[kWindow];
+    nodeMap_.insert(key, node, hash);
+    // 窗口溢出但缓存未满时，候选者直接进入试用段
+    if(sizes_[kWindow] > windowCapacity_){
+        moveTo(kProbation, slab_.front(kWindow));
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void TinyLfuCache<Key, Value, Index, Hash>::evictFromWindow()
+{
+    // 缓存已满：窗口最旧的候选者与试用段最旧的淘汰者比较频次，频次低的一方被淘汰
+    uint32_t candidate = slab_.front(kWindow);
+    uint32_t victim = slab_.front(kProbation);
+    if(victim == NodeSlab::npos) victim = slab_.front(kProtected);
+    if(victim == NodeSlab::npos){
+        removeNode(candidate);
+        return;
+    }
+    uint32_t candidateFreq = sketch_.frequency(slab_[candidate].getHash());
+    uint32_t victimFreq = sketch_.frequency(slab_[victim].getHash());
+    if(candidateFreq > victimFreq){
+        removeNode(victim);
+        moveTo(kProbation, candidate);
+    }else{
+        removeNode(candidate);
+    }
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void TinyLfuCache<Key, Value, Index, Hash>::moveTo(List list, uint32_t node)
+{
+    --sizes_[listOf_[node]];
+    slab_.moveToBack(list, node);
+    listOf_[node] = list;
+    ++sizes_[list];
+}
+
+template<typename Key, typename Value, typename Index, typename Hash>
+void TinyLfuCache<Key, Value, Index, Hash>::removeNode(uint32_t node)
+{
+    --sizes_[listOf_[node]];
+    slab_.unlink(node);
+    nodeMap_.erase(slab_[node].getKey(), slab_[node].getHash());
+    slab_.release(node);
+}
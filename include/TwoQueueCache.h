@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "CachePolicy.h"
+#include "KeyIndex.h"
+#include "LruSlab.h"
+
+// 2Q（Johnson & Shasha，完整版）：
+//   A1in：FIFO，新key先进入这里；期间的再次访问视为短时间内的相关访问，不改变位置
+//   A1out：FIFO，只保留从A1in淘汰的key（不保存value）；在这里命中的key说明确实被反复使用，put时进入Am
+//   Am：LRU，保存被证明是热点的数据
+// 三条链表共用一个LruSlab节点池和一个key索引，A1in -> A1out -> Am的迁移只是在链表之间移动下标
+template<typename Key, typename Value, typename Index = SwissIndex>
+class TwoQueueCache : public cachePolicy<Key, Value>
+{
+public:
+    using NodeSlab = LruSlab<Key, Value>;
+    using Nodemap = typename Index::template Map<Key, uint32_t>;  // key到节点下标的映射，包含A1out中的key
+
+    // kinRatio：A1in占总容量的比例；koutRatio：A1out可记录的key个数相对总容量的比例
+    TwoQueueCache(int capacity, double kinRatio = 0.25, double koutRatio = 0.5)
+    : capacity_(capacity > 0 ? capacity : 0)
+    , kin_(static_cast<size_t>(capacity_ * kinRatio))
+    , kout_(static_cast<size_t>(capacity_ * koutRatio))
+    , nodeMap_(capacity_ + kout_)
+    , slab_(capacity_ + kout_, kListNum)
+    , listOf_(capacity_ + kout_ + kListNum, kA1in)
+    {}
+
+    ~TwoQueueCache() override = default;
+
+    void put(Key key, Value value) override;
+    bool get(Key key, Value& value) override;
+    Value get(Key key) override;
+    void remove(Key key);
+
+private:
+    enum List : uint8_t { kA1in = 0, kA1out = 1, kAm = 2 };
+    static const size_t kListNum = 3;
+
+    void reclaim();                      // 腾出一个常驻位置
+    void moveTo(List list, uint32_t node);
+    void removeNode(uint32_t node);
+
+private:
+    size_t capacity_;
+    size_t kin_;                         // A1in的目标大小
+    size_t kout_;                        // A1out最多记录的key个数
+    size_t sizes_[kListNum] = {0, 0, 0};
+    Nodemap nodeMap_;
+    NodeSlab slab_;
+    std::vector<uint8_t> listOf_;        // 节点下标 -> 所在链表
+    std::mutex mutex_;
+};
+
+template<typename Key, typename Value, typename Index>
+void TwoQueueCache<Key, Value, Index>::put(Key key, Value value)
+{
+    if(capacity_ == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found != nullptr){
+        uint32_t node = *found;
+        switch(listOf_[node]){
+            case kAm:
+                slab_[node].setValue(value);
+                slab_.moveToBack(kAm, node);
+                return;
+            case kA1in:
+                slab_[node].setValue(value);
+                return;
+            case kA1out:
+                // 幽灵命中：先从A1out摘下，避免腾位置时被当作最旧的key删掉，再进入Am
+                slab_.unlink(node);
+                --sizes_[kA1out];
+                reclaim();
+                slab_[node].setValue(value);
+                slab_.pushBack(kAm, node);
+                listOf_[node] = kAm;
+                ++sizes_[kAm];
+                return;
+        }
+    }
+    reclaim();
+    uint32_t node = slab_.allocate(key, value);
+    slab_.pushBack(kA1in, node);
+    listOf_[node] = kA1in;
+    ++sizes_[kA1in];
+    nodeMap_.insert(key, node);
+}
+
+template<typename Key, typename Value, typename Index>
+bool TwoQueueCache<Key, Value, Index>::get(Key key, Value& value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found == nullptr) return false;
+    uint32_t node = *found;
+    switch(listOf_[node]){
+        case kAm:
+            slab_.moveToBack(kAm, node);
+            break;
+        case kA1in:
+            break;
+        case kA1out:
+            return false;
+    }
+    value = slab_[node].getValue();
+    return true;
+}
+
+template<typename Key, typename Value, typename Index>
+Value TwoQueueCache<Key, Value, Index>::get(Key key)
+{
+    Value value{};
+    get(key, value);
+    return value;
+}
+
+template<typename Key, typename Value, typename Index>
+void TwoQueueCache<Key, Value, Index>::remove(Key key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t* found = nodeMap_.find(key);
+    if(found != nullptr){
+        removeNode(*found);
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void TwoQueueCache<Key, Value, Index>::reclaim()
+{
+    if(sizes_[kA1in] + sizes_[kAm] < capacity_) return;
+    if(sizes_[kA1in] > kin_ || sizes_[kAm] == 0){
+        // A1in超过目标大小：最旧的节点丢掉value转入A1out，A1out满了先删掉最旧的key
+        uint32_t node = slab_.front(kA1in);
+        if(kout_ == 0){
+            removeNode(node);
+            return;
+        }
+        if(sizes_[kA1out] >= kout_){
+            removeNode(slab_.front(kA1out));
+        }
+        slab_[node].setValue(Value());
+        moveTo(kA1out, node);
+    }else{
+        removeNode(slab_.front(kAm));
+    }
+}
+
+template<typename Key, typename Value, typename Index>
+void TwoQueueCache<Key, Value, Index>::moveTo(List list, uint32_t node)
+{
+    --sizes_[listOf_[node]];
+    slab_.moveToBack(list, node);
+    listOf_[node] = list;
+    ++sizes_[list];
+}
+
+template<typename Key, typename Value, typename Index>
+void TwoQueueCache<Key, Value, Index>::removeNode(uint32_t node)
+{
+    --sizes_[listOf_[node]];
+    slab_.unlink(node);
+    nodeMap_.erase(slab_[node].getKey());
+    slab_.release(node);
+}
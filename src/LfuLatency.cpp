@@ -0,0 +1,68 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "LfuCache.h"
+
+// LFU单次操作延迟分布：平均访问频次超过maxAverageNum时触发频次老化
+// 老化若在一次操作中遍历全部节点，会在高分位上出现毫秒级尖刺；这里统计每次put/get的耗时分位数
+
+static volatile size_t sink = 0;  // 防止get结果被优化掉
+
+void printPercentile(const char* name, const std::vector<double>& sorted, double ratio)
+{
+    size_t index = static_cast<size_t>(ratio * (sorted.size() - 1));
+    std::cout << std::left << std::setw(10) << name << std::fixed << std::setprecision(0)
+              << sorted[index] << " ns" << std::endl;
+}
+
+void runLatency(int capacity, int maxAverageNum, int operations)
+{
+    LfuCache<int, std::string> lfu(capacity, maxAverageNum);
+    std::mt19937 gen(42);
+    const int KEY_SPACE = capacity + capacity / 2;
+    const int HOT_KEYS = capacity / 10;
+
+    // 预热缓存
+    for (int k = 0; k < capacity; ++k) {
+        lfu.put(k, "v" + std::to_string(k));
+    }
+
+    std::vector<double> latency;
+    latency.reserve(operations);
+    std::string value;
+    for (int op = 0; op < operations; ++op) {
+        bool isPut = (gen() % 100 < 30);
+        int key = (gen() % 100 < 70) ? gen() % HOT_KEYS : gen() % KEY_SPACE;
+        auto timeStart = std::chrono::steady_clock::now();
+        if (isPut) {
+            lfu.put(key, value);
+        } else {
+            sink += lfu.get(key, value);
+        }
+        auto timeEnd = std::chrono::steady_clock::now();
+        latency.push_back(std::chrono::duration<double, std::nano>(timeEnd - timeStart).count());
+    }
+
+    std::sort(latency.begin(), latency.end());
+    std::cout << "\n=== capacity=" << capacity << " maxAverageNum=" << maxAverageNum
+              << " ops=" << operations << " ===" << std::endl;
+    printPercentile("p50", latency, 0.5);
+    printPercentile("p99", latency, 0.99);
+    printPercentile("p99.9", latency, 0.999);
+    printPercentile("p99.99", latency, 0.9999);
+    printPercentile("max", latency, 1.0);
+    size_t spikes = latency.end() - std::upper_bound(latency.begin(), latency.end(), 100000.0);
+    std::cout << std::left << std::setw(10) << ">100us" << spikes << " ops" << std::endl;
+}
+
+int main()
+{
+    runLatency(10000, 10, 2000000);
+    runLatency(100000, 10, 2000000);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <unordered_set>
+
+#include "HashLruCache.h"
+#include "HashLfuCache.h"
+#include "ArcHashCache.h"
+
+// 分片负载对比：同一组操作分别按旧的std::hash % 分片数和新的CacheHash高位掩码路由
+// 输出每个分片收到的操作数和不同key的个数（即该分片需要容纳的数据量），以及最大值与平均值之比
+// 整数key的std::hash是恒等映射，顺序或按分片数步进的key在旧路由下会集中到少数分片
+
+static volatile size_t sink = 0;  // 防止结果被优化掉
+
+const int SLICES = 8;
+const int OPERATIONS = 400000;
+
+template<typename Key>
+struct Workload {
+    std::string name;
+    std::vector<Key> keys;    // 按操作顺序排列的key
+};
+
+Workload<int> sequentialKeys()
+{
+    Workload<int> w{"顺序整数", {}};
+    for (int i = 0; i < OPERATIONS; i++) w.keys.push_back(i % 4096);
+    return w;
+}
+
+Workload<int> stridedKeys(int stride)
+{
+    Workload<int> w{"步长" + std::to_string(stride) + "整数", {}};
+    std::mt19937 gen(42);
+    for (int i = 0; i < OPERATIONS; i++) w.keys.push_back(static_cast<int>(gen() % 4096) * stride);
+    return w;
+}
+
+Workload<std::string> stringKeys()
+{
+    Workload<std::string> w{"字符串", {}};
+    std::mt19937 gen(42);
+    for (int i = 0; i < OPERATIONS; i++) {
+        w.keys.push_back("user:" + std::to_string(gen() % 4096) + ":profile");
+    }
+    return w;
+}
+
+template<typename Key>
+void reportShards(const std::string& title, const Workload<Key>& w, std::function<size_t(const Key&)> route)
+{
+    std::vector<size_t> ops(SLICES, 0);
+    std::vector<std::unordered_set<Key>> keys(SLICES);
+    for (const auto& key : w.keys) {
+        size_t slice = route(key);
+        ops[slice]++;
+        keys[slice].insert(key);
+    }
+    size_t maxOps = 0, maxKeys = 0, totalKeys = 0;
+    std::cout << w.name << "  " << std::left << std::setw(14) << title;
+    for (int i = 0; i < SLICES; i++) {
+        std::cout << std::setw(12) << (std::to_string(ops[i]) + "/" + std::to_string(keys[i].size()));
+        if (ops[i] > maxOps) maxOps = ops[i];
+        if (keys[i].size() > maxKeys) maxKeys = keys[i].size();
+        totalKeys += keys[i].size();
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << "操作 " << maxOps * SLICES / static_cast<double>(w.keys.size())
+              << "  key " << maxKeys * SLICES / static_cast<double>(totalKeys) << std::endl;
+}
+
+template<typename Cache, typename Key>
+double benchCache(Cache& cache, const Workload<Key>& w)
+{
+    size_t hits = 0;
+    int value = 0;
+    auto timeStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < w.keys.size(); i++) {
+        if (i % 10 < 3) cache.put(w.keys[i], static_cast<int>(i));
+        else if (cache.get(w.keys[i], value)) hits++;
+    }
+    auto timeEnd = std::chrono::steady_clock::now();
+    sink += hits;
+    return std::chrono::duration<double, std::nano>(timeEnd - timeStart).count() / w.keys.size();
+}
+
+template<typename Key>
+void runWorkload(const Workload<Key>& w)
+{
+    HashLruCache<Key, int> lru(1024, SLICES);
+    HashLfuCache<Key, int> lfu(1024, SLICES);
+    ArcHashCache<Key, int> arc(1024, SLICES, 2);
+
+    std::hash<Key> stdHash;
+    reportShards<Key>("std::hash%n", w, [&](const Key& key) { return stdHash(key) % SLICES; });
+    reportShards<Key>("CacheHash", w, [&](const Key& key) { return lru.sliceIndex(key); });
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "    ns/op  HashLRU " << benchCache(lru, w)
+              << "  HashLFU " << benchCache(lfu, w)
+              << "  HashARC " << benchCache(arc, w) << std::endl;
+}
+
+int main()
+{
+    std::cout << "=== 分片负载（" << SLICES << "个分片，每格为 操作数/不同key数，最后两列为最大值与平均值之比） ===" << std::endl;
+    runWorkload(sequentialKeys());
+    runWorkload(stridedKeys(SLICES));
+    runWorkload(stridedKeys(64));
+    runWorkload(stringKeys());
+
+    // 分片数不是2的幂时向上取整
+    HashLruCache<int, int> rounded(1024, 6);
+    std::cout << "\n分片数6向上取整为: " << rounded.sliceNum() << std::endl;
+    return 0;
+}
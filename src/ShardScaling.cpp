@@ -0,0 +1,124 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "LruCache.h"
+#include "ShardArray.h"
+
+// 分片布局对线程扩展性的影响：每个线程只访问属于自己的分片，分片之间没有锁竞争，
+// 吞吐量不随线程数线性增长的部分来自相邻分片共享缓存行（伪共享）
+//   独立分配：原来的vector<unique_ptr>，每个分片单独new，相邻的堆块可能落在同一缓存行
+//   紧密排列：分片连续存放、不做填充，相邻分片的锁和字段必然共享缓存行，作为最坏情况
+//   ShardArray：分片连续存放，每个分片按64字节对齐并填充
+
+using Shard = LruCache<int, int>;
+
+const size_t SLICES = 8;
+const int SLICE_CAPACITY = 64;
+const int KEYS_PER_THREAD = 48;     // 小于分片容量，全部命中，热数据留在各核的缓存中
+const int OPS_PER_THREAD = 2000000;
+
+static std::atomic<size_t> sink(0);  // 防止结果被优化掉
+
+size_t routeOf(int key)
+{
+    return shardOf(cacheHashOf(CacheHash<int>(), key), SLICES - 1);
+}
+
+// 找出落在指定分片上的key
+std::vector<int> keysOfSlice(size_t slice)
+{
+    std::vector<int> keys;
+    for (int key = 0; keys.size() < static_cast<size_t>(KEYS_PER_THREAD); key++) {
+        if (routeOf(key) == slice) keys.push_back(key);
+    }
+    return keys;
+}
+
+struct SeparateSlices {
+    static const char* name() { return "独立分配"; }
+    explicit SeparateSlices(size_t count) {
+        for (size_t i = 0; i < count; i++) slices.emplace_back(new Shard(SLICE_CAPACITY));
+    }
+    Shard& operator[](size_t i) { return *slices[i]; }
+    std::vector<std::unique_ptr<Shard>> slices;
+};
+
+template<size_t Align, const char* (*Name)()>
+struct ContiguousSlices {
+    static const char* name() { return Name(); }
+    explicit ContiguousSlices(size_t count) : slices(count) {
+        for (size_t i = 0; i < count; i++) slices.emplace_back(SLICE_CAPACITY);
+    }
+    Shard& operator[](size_t i) { return slices[i]; }
+    ShardArray<Shard, Align> slices;
+};
+
+const char* packedName() { return "紧密排列"; }
+const char* alignedName() { return "ShardArray"; }
+
+using PackedSlices = ContiguousSlices<alignof(Shard), packedName>;
+using AlignedSlices = ContiguousSlices<kCacheLineSize, alignedName>;
+
+template<typename Slices>
+double runThreads(int nthreads)
+{
+    Slices slices(SLICES);
+    std::vector<std::vector<int>> keys;
+    for (int t = 0; t < nthreads; t++) keys.push_back(keysOfSlice(t % SLICES));
+
+    std::atomic<int> ready(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++) {
+        threads.emplace_back([&, t]() {
+            const std::vector<int>& myKeys = keys[t];
+            Shard& shard = slices[t % SLICES];
+            size_t hits = 0;
+            int value = 0;
+            ready++;
+            while (!start.load()) std::this_thread::yield();
+            for (int i = 0; i < OPS_PER_THREAD; i++) {
+                int key = myKeys[i % KEYS_PER_THREAD];
+                size_t hash = cacheHashOf(CacheHash<int>(), key);
+                if (i % 10 < 3) shard.put(key, i, hash);
+                else if (shard.get(key, value, hash)) hits++;
+            }
+            sink += hits;
+        });
+    }
+    while (ready.load() < nthreads) std::this_thread::yield();
+    auto timeStart = std::chrono::steady_clock::now();
+    start = true;
+    for (auto& th : threads) th.join();
+    auto timeEnd = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(timeEnd - timeStart).count();
+    return nthreads * static_cast<double>(OPS_PER_THREAD) / seconds / 1e6;
+}
+
+template<typename Slices>
+void runLayout()
+{
+    std::cout << Slices::name() << "\t";
+    for (int nthreads : {1, 2, 4, 8}) {
+        std::cout << std::left << std::setw(12) << std::fixed << std::setprecision(2) << runThreads<Slices>(nthreads);
+    }
+    std::cout << std::endl;
+}
+
+int main()
+{
+    std::cout << "分片对象大小: " << sizeof(Shard) << "字节，ShardArray中每个分片占 "
+              << ((sizeof(Shard) + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize) << "字节" << std::endl;
+    std::cout << "硬件线程数: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << "=== 吞吐量（百万次操作/秒），列为线程数1、2、4、8 ===" << std::endl;
+    runLayout<SeparateSlices>();
+    runLayout<PackedSlices>();
+    runLayout<AlignedSlices>();
+    return 0;
+}
@@ -4,10 +4,23 @@
 #include "LruCache.h"
 #include "LfuCache.h"
 #include "LruKCache.h"
+#include "HashLruKCache.h"
 #include "HashLruCache.h"
 #include "HashLfuCache.h"
 #include "ArcCache.h"
 #include "ArcHashCache.h"
+#include "AdaptiveArcCache.h"
+#include "ConcurrentLruCache.h"
+#include "TinyLfuCache.h"
+#include "HashTinyLfuCache.h"
+#include "S3FifoCache.h"
+#include "ClockCache.h"
+#include "ClockProCache.h"
+#include "HashClockCache.h"
+#include "SlruCache.h"
+#include "TwoQueueCache.h"
+#include "LirsCache.h"
+#include "HashLirsCache.h"
 
 int main() {
     // LRU
@@ -16,6 +29,19 @@ int main() {
     testLru.testHotData();
     testLru.testLoop();
     testLru.testWorkloadShift();
+    // LRU（读写锁）：命中写入访问缓冲后批量调整顺序，对比命中率的变化
+    using BufferedLru = LruCache<int, std::string, SwissIndex, CacheHash<int>, SharedSpinLock>;
+    BufferedLru bufferedLru(50);
+    TestBase<BufferedLru> testBufferedLru(bufferedLru,"LRU(缓冲命中)");
+    testBufferedLru.testHotData();
+    testBufferedLru.testLoop();
+    testBufferedLru.testWorkloadShift();
+    // LRU（提升节流）：命中的节点距最近使用端不超过容量的1/4时不移动
+    LruCache<int, std::string> throttledLru(50, 0.25);
+    TestBase<LruCache<int, std::string>> testThrottledLru(throttledLru,"LRU(提升节流)");
+    testThrottledLru.testHotData();
+    testThrottledLru.testLoop();
+    testThrottledLru.testWorkloadShift();
     // LFU
     LfuCache<int, std::string> lfu(50, 1000);
     TestBase<LfuCache<int, std::string>> testLfu(lfu,"LFU");
@@ -28,30 +54,132 @@ int main() {
     testLruk.testHotData();
     testLruk.testLoop();
     testLruk.testWorkloadShift();
+    //HashLRU-K
+    HashLruKCache<int, std::string> hashLruk(50, 4, 500, 2);
+    TestBase<HashLruKCache<int, std::string>> testHashLruk(hashLruk,"HashLRU-K");
+    testHashLruk.testHotData();
+    testHashLruk.testLoop();
+    testHashLruk.testWorkloadShift();
     //HashLRU
     HashLruCache<int, std::string> hashLru(50, 4);
     TestBase<HashLruCache<int, std::string>> testHashLru(hashLru,"HashLRU");
     testHashLru.testHotData();
     testHashLru.testLoop();
     testHashLru.testWorkloadShift();
+    // HashLRU（容量再平衡）：总容量不变，按分片的未命中数在分片之间调配容量
+    HashLruCache<int, std::string> rebalancedHashLru(50, 4, 0, true);
+    TestBase<HashLruCache<int, std::string>> testRebalancedHashLru(rebalancedHashLru,"HashLRU(容量再平衡)");
+    testRebalancedHashLru.testHotData();
+    testRebalancedHashLru.testLoop();
+    testRebalancedHashLru.testWorkloadShift();
     //HashLFU
     HashLfuCache<int, std::string> hashLfu(50, 4);
     TestBase<HashLfuCache<int, std::string>> testHashLfu(hashLfu,"HashLFU");
     testHashLfu.testHotData();
     testHashLfu.testLoop();
     testHashLfu.testWorkloadShift();
+    // HashLFU（容量再平衡）
+    HashLfuCache<int, std::string> rebalancedHashLfu(50, 4, true);
+    TestBase<HashLfuCache<int, std::string>> testRebalancedHashLfu(rebalancedHashLfu,"HashLFU(容量再平衡)");
+    testRebalancedHashLfu.testHotData();
+    testRebalancedHashLfu.testLoop();
+    testRebalancedHashLfu.testWorkloadShift();
     //ARC
     ArcCache<int, std::string> arc(50, 2);
     TestBase<ArcCache<int, std::string>> testArc(arc,"ARC");
     testArc.testHotData();
     testArc.testLoop();
     testArc.testWorkloadShift();
+    // ARC（提升节流）
+    ArcCache<int, std::string> throttledArc(50, 2, 0.25);
+    TestBase<ArcCache<int, std::string>> testThrottledArc(throttledArc,"ARC(提升节流)");
+    testThrottledArc.testHotData();
+    testThrottledArc.testLoop();
+    testThrottledArc.testWorkloadShift();
     //ARCHash
     ArcHashCache<int, std::string> hashArc(50, 4, 2);
     TestBase<ArcHashCache<int, std::string>> testHashArc(hashArc,"HashARC");
     testHashArc.testHotData();
     testHashArc.testLoop();
     testHashArc.testWorkloadShift();
+    // HashARC（容量再平衡）
+    ArcHashCache<int, std::string> rebalancedHashArc(50, 4, 2, 0, true);
+    TestBase<ArcHashCache<int, std::string>> testRebalancedHashArc(rebalancedHashArc,"HashARC(容量再平衡)");
+    testRebalancedHashArc.testHotData();
+    testRebalancedHashArc.testLoop();
+    testRebalancedHashArc.testWorkloadShift();
+    // ConcurrentLRU：不分片，全局CLOCK淘汰，分段加锁的索引
+    ConcurrentLruCache<int, std::string> concurrentLru(50);
+    TestBase<ConcurrentLruCache<int, std::string>> testConcurrentLru(concurrentLru,"ConcurrentLRU");
+    testConcurrentLru.testHotData();
+    testConcurrentLru.testLoop();
+    testConcurrentLru.testWorkloadShift();
+    //自适应p的标准ARC
+    AdaptiveArcCache<int, std::string> adaptiveArc(50);
+    TestBase<AdaptiveArcCache<int, std::string>> testAdaptiveArc(adaptiveArc,"AdaptiveARC");
+    testAdaptiveArc.testHotData();
+    testAdaptiveArc.testLoop();
+    testAdaptiveArc.testWorkloadShift();
+    //W-TinyLFU
+    TinyLfuCache<int, std::string> tinyLfu(50);
+    TestBase<TinyLfuCache<int, std::string>> testTinyLfu(tinyLfu,"TinyLFU");
+    testTinyLfu.testHotData();
+    testTinyLfu.testLoop();
+    testTinyLfu.testWorkloadShift();
+    //HashTinyLFU
+    HashTinyLfuCache<int, std::string> hashTinyLfu(50, 4);
+    TestBase<HashTinyLfuCache<int, std::string>> testHashTinyLfu(hashTinyLfu,"HashTinyLFU");
+    testHashTinyLfu.testHotData();
+    testHashTinyLfu.testLoop();
+    testHashTinyLfu.testWorkloadShift();
+    //S3-FIFO
+    S3FifoCache<int, std::string> s3fifo(50);
+    TestBase<S3FifoCache<int, std::string>> testS3Fifo(s3fifo,"S3-FIFO");
+    testS3Fifo.testHotData();
+    testS3Fifo.testLoop();
+    testS3Fifo.testWorkloadShift();
+    //CLOCK
+    ClockCache<int, std::string> clock(50);
+    TestBase<ClockCache<int, std::string>> testClock(clock,"CLOCK");
+    testClock.testHotData();
+    testClock.testLoop();
+    testClock.testWorkloadShift();
+    //CLOCK-Pro
+    ClockProCache<int, std::string> clockPro(50);
+    TestBase<ClockProCache<int, std::string>> testClockPro(clockPro,"CLOCK-Pro");
+    testClockPro.testHotData();
+    testClockPro.testLoop();
+    testClockPro.testWorkloadShift();
+    //HashCLOCK
+    HashClockCache<int, std::string> hashClock(50, 4);
+    TestBase<HashClockCache<int, std::string>> testHashClock(hashClock,"HashCLOCK");
+    testHashClock.testHotData();
+    testHashClock.testLoop();
+    testHashClock.testWorkloadShift();
+    //SLRU
+    SlruCache<int, std::string> slru(50);
+    TestBase<SlruCache<int, std::string>> testSlru(slru,"SLRU");
+    testSlru.testHotData();
+    testSlru.testLoop();
+    testSlru.testWorkloadShift();
+    //2Q
+    TwoQueueCache<int, std::string> twoQueue(50);
+    TestBase<TwoQueueCache<int, std::string>> testTwoQueue(twoQueue,"2Q");
+    testTwoQueue.testHotData();
+    testTwoQueue.testLoop();
+    testTwoQueue.testWorkloadShift();
+    //LIRS
+    LirsCache<int, std::string> lirs(50);
+    TestBase<LirsCache<int, std::string>> testLirs(lirs,"LIRS");
+    testLirs.testHotData();
+    testLirs.testLoop();
+    testLirs.testWorkloadShift();
+    //HashLIRS
+    HashLirsCache<int, std::string> hashLirs(50, 4);
+    TestBase<HashLirsCache<int, std::string>> testHashLirs(hashLirs,"HashLIRS");
+    testHashLirs.testHotData();
+    testHashLirs.testLoop();
+    testHashLirs.testWorkloadShift();
 
     return 0;
 }
\ No newline at end of file
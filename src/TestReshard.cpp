@@ -0,0 +1,106 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+
+#include "HashLruCache.h"
+#include "ArcHashCache.h"
+
+// 在线改变分片数的一致性测试：多个线程各自读写互不相交的key，并在本地记下每个key最后写入的value；
+// 另一个线程不停地reshard（拆分、合并）和resize。命中时读到的value必须等于本线程最后一次写入的值，
+// 读到更早的值（旧值）说明迁移丢失了写入。未命中是允许的（淘汰）。有旧值时返回1
+
+const int THREADS = 4;
+const int OPS_PER_THREAD = 150000;
+const int HOT_KEYS = 200;           // 70%的操作落在热点key上
+const int COLD_KEYS = 3000;
+
+struct Result {
+    long stale = 0;
+    long hits = 0;
+    long gets = 0;
+    int reshards = 0;
+};
+
+template<typename Cache>
+Result runReshardStress(Cache& cache, unsigned seed)
+{
+    Result result;
+    std::atomic<long> stale(0), hits(0), gets(0);
+    std::atomic<bool> done(false);
+    std::atomic<int> reshards(0);
+    std::thread controller([&]{
+        std::mt19937 gen(seed);
+        const int sliceNums[] = {1, 2, 4, 8, 16, 32};
+        while (!done.load()) {
+            if (cache.reshard(sliceNums[gen() % 6])) reshards++;
+            if (gen() % 4 == 0) cache.resize(1000 + gen() % 4000);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+    std::vector<std::thread> workers;
+    for (int t = 0; t < THREADS; t++) {
+        workers.emplace_back([&, t]{
+            std::mt19937 gen(seed * 131 + t);
+            std::unordered_map<int, int> written;   // 本线程每个key最后写入的value
+            long localStale = 0, localHits = 0, localGets = 0;
+            for (int op = 0; op < OPS_PER_THREAD; op++) {
+                int key = t * 1000000 + static_cast<int>(gen() % 100 < 70 ? gen() % HOT_KEYS : gen() % COLD_KEYS);
+                if (gen() % 10 < 3) {
+                    int value = static_cast<int>(gen());
+                    written[key] = value;
+                    cache.put(key, value);
+                } else {
+                    int value;
+                    localGets++;
+                    if (cache.get(key, value)) {
+                        localHits++;
+                        auto it = written.find(key);
+                        if (it == written.end() || it->second != value) localStale++;
+                    }
+                }
+            }
+            stale += localStale;
+            hits += localHits;
+            gets += localGets;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    done = true;
+    controller.join();
+    result.stale = stale.load();
+    result.hits = hits.load();
+    result.gets = gets.load();
+    result.reshards = reshards.load();
+    return result;
+}
+
+template<typename Cache>
+long report(const std::string& name, Cache& cache, unsigned seed)
+{
+    Result result = runReshardStress(cache, seed);
+    std::cout << std::left << std::setw(24) << name
+              << "reshard次数: " << std::setw(6) << result.reshards
+              << "命中率: " << std::fixed << std::setprecision(1) << std::setw(7) << 100.0 * result.hits / result.gets
+              << "旧值: " << result.stale << std::endl;
+    return result.stale;
+}
+
+int main()
+{
+    const int ROUNDS = 3;
+    long stale = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        unsigned seed = 99 + round;
+        { HashLruCache<int, int> cache(4096, 4); stale += report("HashLRU", cache, seed); }
+        { HashLruCache<int, int, SwissIndex, CacheHash<int>, SharedSpinLock> cache(4096, 4); stale += report("HashLRU SharedSpinLock", cache, seed); }
+        { ArcHashCache<int, int> cache(4096, 4, 2); stale += report("ArcHash", cache, seed); }
+    }
+    std::cout << (stale == 0 ? "通过：没有读到旧值" : "失败：读到旧值") << std::endl;
+    return stale == 0 ? 0 : 1;
+}
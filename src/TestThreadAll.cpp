@@ -1,3 +1,5 @@
+#include<atomic>
+#include<chrono>
 #include<iostream>
 #include<thread>
 #include<string>
@@ -5,10 +7,15 @@
 #include "LruCache.h"
 #include "LfuCache.h"
 #include "LruKCache.h"
+#include "HashLruKCache.h"
 #include "HashLruCache.h"
 #include "HashLfuCache.h"
 #include "ArcCache.h"
 #include "ArcHashCache.h"
+#include "S3FifoCache.h"
+#include "ClockCache.h"
+#include "ConcurrentLruCache.h"
+#include "LockPolicy.h"
 
 #include "ThreadPool.h"
 #include "TestThread.h"
@@ -17,13 +24,64 @@ template<typename Cache>
 void runAllTests(const std::string& title, Cache& cache, ThreadPool *pool, int nthreads, int mode)
 {
     std::cout<< title<<std::endl;
-    TestRunner<ArcHashCache<int, std::string>, ThreadPool> runner(cache, pool, nthreads, mode);
+    TestRunner<Cache, ThreadPool> runner(cache, pool, nthreads, mode);
     runner.testHotData(50,200000,50,500);
     runner.testLoop(50,200,200000);
     runner.testWorkloadShift(50,200000);
     std::cout<<std::endl;
 }
 
+// 线程数扩展性测试：同样的操作序列，观察吞吐量随线程数的变化
+template<typename Cache, typename... Args>
+void runScalingTest(const std::string& title, Args... args)
+{
+    std::cout << title << std::endl;
+    for (int nthreads : {1, 2, 4, 8}) {
+        Cache cache(args...);
+        TestRunner<Cache, ThreadPool> runner(cache, nullptr, nthreads, nthreads > 1 ? 1 : 0);
+        runner.testHotData(50,200000,50,500);
+    }
+    std::cout << std::endl;
+}
+
+// 锁策略对比：同一个LRU和同样的操作序列，只换Lock模板参数；NullLock不是线程安全的，只测单线程
+template<typename Lock>
+void runLockTest(const std::string& name, bool threadSafe)
+{
+    using Cache = LruCache<int, std::string, SwissIndex, CacheHash<int>, Lock>;
+    std::cout << "LRU锁策略测试: " << name << std::endl;
+    Cache single(50);
+    TestRunner<Cache, ThreadPool> singleRunner(single, nullptr, 1, 0);
+    singleRunner.testHotData(50,200000,50,500);
+    if (threadSafe) {
+        Cache multi(50);
+        TestRunner<Cache, ThreadPool> multiRunner(multi, nullptr, 4, 1);
+        multiRunner.testHotData(50,200000,50,500);
+    }
+    std::cout << std::endl;
+}
+
+// 在线改变分片数：多线程工作负载运行期间，另一个线程不断reshard，条目逐步迁移，命中率应与不改变分片数时接近
+template<typename Cache>
+void runReshardTest(const std::string& title, Cache& cache)
+{
+    std::cout << title << std::endl;
+    std::atomic<bool> done(false);
+    std::atomic<int> reshards(0);
+    std::thread resharder([&cache, &done, &reshards]{
+        const int sliceNums[] = {8, 16, 2, 32};
+        for (int round = 0; !done.load(); round++) {
+            if (cache.reshard(sliceNums[round % 4])) reshards++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    TestRunner<Cache, ThreadPool> runner(cache, nullptr, 4, 1);
+    runner.testHotData(50,200000,50,500);
+    done = true;
+    resharder.join();
+    std::cout << "reshard次数: " << reshards.load() << "，最终分片数: " << cache.sliceNum() << std::endl << std::endl;
+}
+
 int main()
 {
     using CacheType = ArcHashCache<int, std::string>;
@@ -41,5 +99,44 @@ int main()
     CacheType cache3(50,32,2);
     runAllTests("线程池测试", cache3, &tp , 4, 2);
 
+    // S3-FIFO：命中只加共享锁，与独占锁的LRU直接对比
+    S3FifoCache<int, std::string> s3fifo(50);
+    runAllTests("S3-FIFO多线程测试", s3fifo, nullptr, 4, 1);
+    LruCache<int, std::string> lru(50);
+    runAllTests("LRU多线程测试", lru, nullptr, 4, 1);
+
+    // LRU-K：主缓存和访问历史共用一把锁，多线程下整个操作是原子的
+    LruKCache<int, std::string> lruk(50, 500, 2);
+    runAllTests("LRU-K多线程测试", lruk, nullptr, 4, 1);
+    HashLruKCache<int, std::string> hashLruk(50, 4, 500, 2);
+    runAllTests("HashLRU-K多线程测试", hashLruk, nullptr, 4, 1);
+
+    // 小容量下分片与不分片的命中率对比：ArcHash(50,32,2)每个分片只有2个条目
+    HashLruCache<int, std::string> hashLru32(50, 32);
+    runAllTests("HashLRU(32分片)多线程测试", hashLru32, nullptr, 4, 1);
+    ConcurrentLruCache<int, std::string> concurrentLru(50);
+    runAllTests("ConcurrentLRU多线程测试", concurrentLru, nullptr, 4, 1);
+
+    // 运行中改变分片数，与上面固定分片数的结果对比
+    HashLruCache<int, std::string> reshardLru(50, 4);
+    runReshardTest("HashLRU在线改变分片数多线程测试", reshardLru);
+    ArcHashCache<int, std::string> reshardArc(50, 4, 2);
+    runReshardTest("ArcHash在线改变分片数多线程测试", reshardArc);
+
+    runScalingTest<CacheType>("ArcHash线程数扩展性测试", 50, 32, 2);
+    runScalingTest<ConcurrentLruCache<int, std::string>>("ConcurrentLRU线程数扩展性测试", 50);
+    runScalingTest<S3FifoCache<int, std::string>>("S3-FIFO线程数扩展性测试", 50);
+    runScalingTest<ClockCache<int, std::string>>("CLOCK线程数扩展性测试", 50);
+    runScalingTest<LruCache<int, std::string>>("LRU线程数扩展性测试", 50);
+    // 读写锁下命中只加共享锁，顺序调整写入访问缓冲后批量回放
+    runScalingTest<HashLruCache<int, std::string>>("HashLRU线程数扩展性测试", 50, 4);
+    runScalingTest<HashLruCache<int, std::string, SwissIndex, CacheHash<int>, SharedSpinLock>>("HashLRU(缓冲命中)线程数扩展性测试", 50, 4);
+
+    runLockTest<NullLock>("NullLock", false);
+    runLockTest<std::mutex>("std::mutex", true);
+    runLockTest<SpinLock>("SpinLock", true);
+    runLockTest<AdaptiveLock>("AdaptiveLock", true);
+    runLockTest<SharedSpinLock>("SharedSpinLock", true);
+
     return 0;
 }
\ No newline at end of file